@@ -0,0 +1,79 @@
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "Kernels.hpp"
+#include "WorldRegistry.hpp"
+
+namespace {
+struct Body {
+  float x;
+  float y;
+  float z;
+  float vx;
+  float vy;
+  float vz;
+  float mass;
+  float padding[9];
+};
+}
+
+ECS_SPLIT_COMPONENT(Body, &Body::x, &Body::y, &Body::z, &Body::vx, &Body::vy, &Body::vz, &Body::mass)
+
+TEST_CASE("axpy kernels", "[kernels]") {
+  const std::size_t amount = 1 << 20;
+  std::vector<float> x(amount, 1.0f), y(amount, 0.0f);
+  INFO("kernel isa: " << kernel_isa());
+
+  BENCHMARK("scalar axpy 1M") {
+    axpy_scalar(y.data(), x.data(), 0.016f, amount);
+    return y[0];
+  };
+
+  BENCHMARK("dispatched axpy 1M") {
+    axpy(y.data(), x.data(), 0.016f, amount);
+    return y[0];
+  };
+}
+
+TEST_CASE("Integrating positions", "[kernels]") {
+  const std::size_t amount = 1 << 20;
+  const float dt = 0.016f;
+
+  WorldRegistry registry {};
+  registry.register_component<Body>();
+  registry.create_entities<Body>(amount, [] (std::size_t i) {
+    return std::make_tuple(Body { 0, 0, 0, 1, 2, 3, 1, {} });
+  });
+
+  BENCHMARK("16 float components, split fields, vectorized kernel") {
+    std::size_t rows { 0 };
+    for (auto [bodies]: registry.view<Body>()) {
+      axpy(bodies.aligned<&Body::x>(), bodies.aligned<&Body::vx>(), dt);
+      axpy(bodies.aligned<&Body::y>(), bodies.aligned<&Body::vy>(), dt);
+      axpy(bodies.aligned<&Body::z>(), bodies.aligned<&Body::vz>(), dt);
+      rows += bodies.size();
+    }
+    return rows;
+  };
+
+  BENCHMARK("16 float components, split fields, scalar kernel") {
+    std::size_t rows { 0 };
+    for (auto [bodies]: registry.view<Body>()) {
+      axpy_scalar(bodies.get<&Body::x>().data(), bodies.get<&Body::vx>().data(), dt, bodies.size());
+      axpy_scalar(bodies.get<&Body::y>().data(), bodies.get<&Body::vy>().data(), dt, bodies.size());
+      axpy_scalar(bodies.get<&Body::z>().data(), bodies.get<&Body::vz>().data(), dt, bodies.size());
+      rows += bodies.size();
+    }
+    return rows;
+  };
+
+  std::vector<Body> structs(amount, Body { 0, 0, 0, 1, 2, 3, 1, {} });
+  BENCHMARK("16 float components, array of structs") {
+    for (Body &body: structs) {
+      body.x += body.vx * dt;
+      body.y += body.vy * dt;
+      body.z += body.vz * dt;
+    }
+    return structs[0].x;
+  };
+}
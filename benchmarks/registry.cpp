@@ -0,0 +1,191 @@
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "WorldRegistry.hpp"
+
+namespace {
+/*! @brief One of the 16 component types of the benchmarks */
+template <std::size_t I>
+struct Data {
+  float value;
+};
+
+/*! @brief Component added and removed by the migration benchmarks */
+struct Extra {
+  float value;
+};
+
+/*! @brief Creates a serial registry with the components of the benchmarks */
+template <std::size_t ...I>
+std::unique_ptr<WorldRegistry> make_registry(std::index_sequence<I...>) {
+  std::unique_ptr<WorldRegistry> registry { std::make_unique<WorldRegistry>(10, 1) };
+  (registry->register_component<Data<I>>(), ...);
+  registry->register_component<Extra>();
+  return registry;
+}
+
+/*! @brief Creates one registry per run, so the measured runs all start from the same state */
+template <std::size_t ...I>
+std::vector<std::unique_ptr<WorldRegistry>> make_registries(int runs, std::index_sequence<I...> components) {
+  std::vector<std::unique_ptr<WorldRegistry>> registries;
+  for (int run = 0; run < runs; ++run) {
+    registries.push_back(make_registry(components));
+  }
+  return registries;
+}
+
+/*!
+ * @brief Benchmarks the entity operations of the registry
+ * @param amount Amount of entities
+ * @param components The components of the entities (1, 4 or 16)
+ */
+template <std::size_t ...I>
+void entity_benchmarks(std::size_t amount, std::index_sequence<I...> components) {
+  std::string suffix { " [" + std::to_string(amount) + " entities, " + std::to_string(sizeof...(I)) + " components]" };
+
+  BENCHMARK_ADVANCED("create_entity" + suffix)(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::unique_ptr<WorldRegistry>> registries { make_registries(meter.runs(), components) };
+    meter.measure([&] (int run) {
+      EntityId last { 0 };
+      for (std::size_t i = 0; i < amount; ++i) {
+        last = registries[run]->create_entity<Data<I>...>();
+      }
+      return last;
+    });
+  };
+
+  BENCHMARK_ADVANCED("create_entities" + suffix)(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::unique_ptr<WorldRegistry>> registries { make_registries(meter.runs(), components) };
+    meter.measure([&] (int run) {
+      return registries[run]->create_entities<Data<I>...>(amount).size();
+    });
+  };
+
+  std::unique_ptr<WorldRegistry> registry { make_registry(components) };
+  std::vector<EntityId> entities { registry->create_entities<Data<I>...>(amount) };
+
+  BENCHMARK("attach_component" + suffix) {
+    for (EntityId entity: entities) {
+      registry->attach_component(entity, Data<0> { 1.0f });
+    }
+    return entities.size();
+  };
+
+  BENCHMARK("get_component" + suffix) {
+    float sum { 0 };
+    for (EntityId entity: entities) {
+      sum += registry->get_component<Data<0>>(entity)->value;
+    }
+    return sum;
+  };
+
+  BENCHMARK("try_get" + suffix) {
+    float sum { 0 };
+    for (EntityId entity: entities) {
+      sum += registry->try_get<Data<0>>(entity)->value;
+    }
+    return sum;
+  };
+
+  BENCHMARK("get of every component" + suffix) {
+    float sum { 0 };
+    for (EntityId entity: entities) {
+      std::tuple<Data<I>*...> components { registry->get<Data<I>...>(entity) };
+      sum += (std::get<Data<I>*>(components)->value + ...);
+    }
+    return sum;
+  };
+
+  BENCHMARK("add_component and remove_component" + suffix) {
+    for (EntityId entity: entities) {
+      registry->add_component<Extra>(entity);
+    }
+    for (EntityId entity: entities) {
+      registry->remove_component<Extra>(entity);
+    }
+    return entities.size();
+  };
+
+  BENCHMARK("add_component and remove_component over a view" + suffix) {
+    std::size_t moved { registry->add_component<Extra>(registry->view<Data<0>>()) };
+    return moved + registry->remove_component<Extra>(registry->view<Extra>());
+  };
+
+  std::unique_ptr<WorldRegistry> ticking { make_registry(components) };
+  ticking->create_entities<Data<I>...>(amount);
+  ticking->register_system<Data<I>...>([] (Data<I> &...data) {
+    ((data.value += 1.0f), ...);
+  });
+
+  BENCHMARK("System::run" + suffix) {
+    ticking->tick();
+  };
+
+  BENCHMARK_ADVANCED("delete_entity" + suffix)(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::unique_ptr<WorldRegistry>> registries { make_registries(meter.runs(), components) };
+    std::vector<std::vector<EntityId>> created;
+    for (auto &current: registries) {
+      created.push_back(current->create_entities<Data<I>...>(amount));
+    }
+    meter.measure([&] (int run) {
+      for (EntityId entity: created[run]) {
+        registries[run]->delete_entity(entity);
+      }
+      return created[run].size();
+    });
+  };
+}
+
+/*! @brief Runs the entity benchmarks with 1, 4 and 16 components */
+void entity_benchmarks(std::size_t amount) {
+  entity_benchmarks(amount, std::make_index_sequence<1>{});
+  entity_benchmarks(amount, std::make_index_sequence<4>{});
+  entity_benchmarks(amount, std::make_index_sequence<16>{});
+}
+
+/*! @brief Benchmarks creating an archetype and finding it again */
+template <std::size_t ...I>
+void archetype_benchmarks(std::index_sequence<I...> components) {
+  std::string suffix { " [" + std::to_string(sizeof...(I)) + " components]" };
+
+  BENCHMARK_ADVANCED("register_archetype, new" + suffix)(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::unique_ptr<WorldRegistry>> registries { make_registries(meter.runs(), components) };
+    meter.measure([&] (int run) {
+      return registries[run]->register_archetype<Data<I>...>();
+    });
+  };
+
+  std::unique_ptr<WorldRegistry> registry { make_registry(components) };
+  registry->register_archetype<Data<I>...>();
+  std::vector<ComponentId> signature { registry->get_component_id<Data<I>>()... };
+
+  BENCHMARK("register_archetype, existing" + suffix) {
+    return registry->register_archetype(signature);
+  };
+}
+}
+
+TEST_CASE("Registry with 1k entities", "[registry]") {
+  entity_benchmarks(1000);
+}
+
+TEST_CASE("Registry with 100k entities", "[registry]") {
+  entity_benchmarks(100000);
+}
+
+TEST_CASE("Registry with 1M entities", "[registry][.large]") {
+  entity_benchmarks(1000000);
+}
+
+TEST_CASE("Registry with 10M entities", "[registry][.large]") {
+  entity_benchmarks(10000000);
+}
+
+TEST_CASE("Archetype registration", "[registry][archetypes]") {
+  archetype_benchmarks(std::make_index_sequence<1>{});
+  archetype_benchmarks(std::make_index_sequence<4>{});
+  archetype_benchmarks(std::make_index_sequence<16>{});
+}
@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "WorldRegistry.hpp"
+
+namespace {
+/*! @brief One of the 4 component types of the snapshot benchmarks */
+template <std::size_t I>
+struct Field {
+  float value;
+};
+
+/*! @brief Registers the components of the snapshot benchmarks */
+template <std::size_t ...I>
+void register_fields(WorldRegistry &registry, std::index_sequence<I...>) {
+  (registry.register_component<Field<I>>(), ...);
+}
+
+/*!
+ * @brief Benchmarks saving and loading a world of entities with 4 components
+ * @param amount Amount of entities
+ * @param components The components of the entities
+ */
+template <std::size_t ...I>
+void snapshot_benchmarks(std::size_t amount, std::index_sequence<I...> components) {
+  std::string suffix { " [" + std::to_string(amount) + " entities, " + std::to_string(sizeof...(I)) + " components]" };
+  std::string path { "benchmark_snapshot.bin" };
+  {
+    WorldRegistry registry { 10, 1 };
+    register_fields(registry, components);
+    registry.create_entities<Field<I>...>(amount);
+
+    BENCHMARK("save_snapshot" + suffix) {
+      registry.save_snapshot(path);
+    };
+  }
+
+  // Loading replaces the world of the previous run, so the reset of the registry is measured too
+  WorldRegistry registry { 10, 1 };
+  register_fields(registry, components);
+  BENCHMARK("load_snapshot" + suffix) {
+    registry.load_snapshot(path);
+  };
+  std::remove(path.c_str());
+}
+}
+
+TEST_CASE("Snapshot with 100k entities", "[snapshot]") {
+  snapshot_benchmarks(100000, std::make_index_sequence<4>{});
+}
+
+TEST_CASE("Snapshot with 5M entities", "[snapshot][.large]") {
+  snapshot_benchmarks(5000000, std::make_index_sequence<4>{});
+}
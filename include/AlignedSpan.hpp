@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+
+/*! @brief Alignment every chunk array starts at (cache line, also the widest vector register) */
+inline constexpr std::size_t simd_alignment { 64 };
+
+/*!
+ * @brief Span of a chunk array that tells the compiler its start is aligned to simd_alignment,
+ * handed to chunk kernels that want aligned arrays (the kernels take them as __restrict
+ * pointers, as the arrays of different columns never overlap). The chunk behind it is
+ * allocated for a whole chunk of rows, so a kernel may run its last vector past size() as long
+ * as it stays inside the chunk
+ */
+template <typename T>
+class AlignedSpan {
+public:
+  /*! @brief Type of the elements */
+  using element_type = T;
+
+  AlignedSpan() = default;
+
+  /*! @brief Wraps an array whose start is aligned to simd_alignment */
+  AlignedSpan(T *array, std::size_t rows) : array{array}, rows{rows} {};
+
+  /*! @brief Returns the aligned start of the array */
+  T *data() const { return std::assume_aligned<simd_alignment>(array); }
+
+  /*! @brief Returns the amount of rows */
+  std::size_t size() const { return rows; }
+
+  T &operator[](std::size_t row) const { return data()[row]; }
+
+  T *begin() const { return data(); }
+
+  T *end() const { return data() + rows; }
+
+  /*! @brief Drops the alignment information */
+  operator std::span<T>() const { return std::span<T>(array, rows); }
+
+private:
+  /*! @brief Start of the array */
+  T *array { nullptr };
+  /*! @brief Amount of rows */
+  std::size_t rows { 0 };
+};
@@ -5,11 +5,23 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include "Types.hpp"
 #include "Column.hpp"
+#include "ComponentMask.hpp"
 
-/*! @brief Forward declaration of the archetypes graph */
-struct ArchetypeEdge;
+class Archetype;
+
+/*!
+ * @brief Connection to the archetypes reached by adding or removing a component,
+ * nullptr while the transition was not resolved yet
+ */
+struct ArchetypeEdge {
+  ComponentId component;
+  Archetype *add { nullptr };
+  Archetype *remove { nullptr };
+};
 
 /*!
  * @brief Structure of an Archetype in a line of the database
@@ -20,24 +32,95 @@ public:
   /*!
    * @brief The archetype constructor, gets its id from the registry
    * @param id The id of the new archetype
+   * @param chunk_resource Resource the chunks of the columns are allocated from
+   * @param graph_resource Resource the signature, the columns and the edges are allocated from
+   * @param index_resource Resource the entities and the chunk tables are allocated from
    */
-  Archetype(ArchetypeId id, std::vector<ComponentId> ids): id{id}, type{ids} {};
+  Archetype(ArchetypeId id, std::vector<ComponentId> ids,
+            std::pmr::memory_resource *chunk_resource = std::pmr::get_default_resource(),
+            std::pmr::memory_resource *graph_resource = std::pmr::get_default_resource(),
+            std::pmr::memory_resource *index_resource = std::pmr::get_default_resource())
+      : id{id}, type{ids.begin(), ids.end(), graph_resource}, sorted_type{ids.begin(), ids.end(), graph_resource},
+        mask{ids}, column_table{graph_resource}, entities{index_resource}, chunk_resource{chunk_resource},
+        index_resource{index_resource}, components{graph_resource}, edges{graph_resource} {
+    std::sort(sorted_type.begin(), sorted_type.end());
+    column_table.assign(sorted_type.empty() ? 0 : sorted_type.back() + 1, no_column);
+    components.reserve(type.size());
+    for (std::size_t i = 0; i < type.size(); ++i) {
+      column_table[type[i]] = static_cast<uint16_t>(i);
+    }
+  };
 
   /*! @brief Returns the id from the archetype */
   ArchetypeId get_id();
 
-  /*! @brief Returns a reference to the edges of the archetype */
-  std::map<ComponentId, std::shared_ptr<ArchetypeEdge>> &get_edges();
+  /*! @brief Returns a reference to the edges of the archetype, sorted by component */
+  std::pmr::vector<ArchetypeEdge> &get_edges();
+
+  /*! @brief Returns the edge of a component, nullptr when there is none */
+  ArchetypeEdge *find_edge(ComponentId component) {
+    auto edge = std::lower_bound(edges.begin(), edges.end(), component,
+        [] (const ArchetypeEdge &edge, ComponentId component) { return edge.component < component; });
+    if (edge == edges.end() || edge->component != component) {
+      return nullptr;
+    }
+    return &*edge;
+  }
+
+  /*!
+   * @brief Returns the edge of a component, inserting an empty one when there is none.
+   * The reference is invalidated when another edge is inserted
+   */
+  ArchetypeEdge &get_edge(ComponentId component) {
+    auto edge = std::lower_bound(edges.begin(), edges.end(), component,
+        [] (const ArchetypeEdge &edge, ComponentId component) { return edge.component < component; });
+    if (edge == edges.end() || edge->component != component) {
+      edge = edges.insert(edge, ArchetypeEdge { component });
+    }
+    return *edge;
+  }
 
   /*! @brief Returns the archetype signature */
   ArchetypeSignature get_type();
 
+  /*!
+   * @brief Returns the column of a component, nullptr when the archetype does not have it.
+   * The lookup is a load from the component to column table, the columns must exist
+   * (registered archetypes)
+   */
+  Column *find_column(ComponentId component) {
+    if (component >= column_table.size() || column_table[component] == no_column) {
+      return nullptr;
+    }
+    return &components[column_table[component]];
+  }
+
+  /*! @brief Returns the archetype signature sorted by component id (computed once) */
+  std::span<const ComponentId> get_sorted_type() const { return sorted_type; }
+
+  /*! @brief Returns the bitmask of the components of the archetype */
+  const ComponentMask &get_mask() const { return mask; }
+
   /*! @brief Overloads the indexing operator for getting the components */
   Column &operator[] (std::size_t index);
 
   /*! @brief Returns the current amount of registered items */
   std::size_t size() { return _size; }
 
+  /*!
+   * @brief Returns the bytes of the bookkeeping of the archetype: the object, the signatures,
+   * the row to entity table, the edges and the chunk tables of the columns
+   */
+  std::size_t overhead_bytes() const {
+    std::size_t bytes { sizeof(Archetype) + (type.capacity() + sorted_type.capacity()) * sizeof(ComponentId)
+                        + entities.capacity() * sizeof(EntityId) + components.capacity() * sizeof(Column)
+                        + edges.capacity() * sizeof(ArchetypeEdge) + column_table.capacity() * sizeof(uint16_t) };
+    for (const Column &column: components) {
+      bytes += column.overhead_bytes();
+    }
+    return bytes;
+  }
+
   /*! @brief Returns true if there is not dependent type left */
   bool is_empty() {
     return dependent_type == 0;
@@ -53,25 +136,154 @@ public:
     ++dependent_type;
   }
 
-  /*! @brief Returns the row for a new entity */
-  std::size_t assign_row() { 
+  /*!
+   * @brief Returns the row for a new entity, growing every column by one row
+   * @param entity The entity that will own the row
+   */
+  std::size_t assign_row(EntityId entity) { 
+    for (Column &column: components) {
+      column.push_back();
+    }
+    entities.push_back(entity);
     _size++;
     return _size - 1; 
   };
 
+  /*!
+   * @brief Reserves contiguous rows for a batch of entities, growing each column once
+   * @param new_entities The entities that will own the rows, in row order
+   * @return The first assigned row
+   */
+  std::size_t assign_rows(std::span<const EntityId> new_entities) {
+    for (Column &column: components) {
+      column.push_back(new_entities.size());
+    }
+    entities.insert(entities.end(), new_entities.begin(), new_entities.end());
+    _size += new_entities.size();
+    return _size - new_entities.size();
+  }
+
+  /*!
+   * @brief Appends rows moved from another archetype, the shared columns are moved into the new
+   * rows (move constructed) and the others get default rows. The source rows are left
+   * moved-from, to be removed by the caller
+   * @param from The archetype the rows come from
+   * @param row The first moved row of the source
+   * @param amount The amount of moved rows
+   * @return The first assigned row
+   */
+  std::size_t assign_rows_from(Archetype &from, std::size_t row, std::size_t amount) {
+    for (std::size_t i = 0; i < components.size(); ++i) {
+      Column *source { from.find_column(type[i]) };
+      if (source == nullptr) {
+        components[i].push_back(amount);
+      } else {
+        components[i].append(*source, row, amount);
+      }
+    }
+    std::span<const EntityId> moved { from.get_entities(row, amount) };
+    entities.insert(entities.end(), moved.begin(), moved.end());
+    _size += amount;
+    return _size - amount;
+  }
+
+  /*!
+   * @brief Removes a row moving the last row into its place (swap and pop)
+   * @param row The row to be removed
+   * @return The entity that was moved into the row, 0 if no entity was moved
+   */
+  EntityId remove_row(std::size_t row) {
+    for (Column &column: components) {
+      column.delete_component(row);
+    }
+    EntityId moved { 0 };
+    if (row != _size - 1) {
+      moved = entities.back();
+      entities[row] = moved;
+    }
+    entities.pop_back();
+    _size--;
+    return moved;
+  }
+
+  /*!
+   * @brief Removes a range of rows, the last rows of the archetype are moved into the hole
+   * @param row The first removed row
+   * @param amount The amount of removed rows
+   * @return The amount of rows moved into the hole (they start at row)
+   */
+  std::size_t remove_rows(std::size_t row, std::size_t amount) {
+    for (Column &column: components) {
+      column.delete_components(row, amount);
+    }
+    std::size_t tail { std::min(amount, _size - row - amount) };
+    std::copy(entities.end() - tail, entities.end(), entities.begin() + row);
+    entities.resize(_size - amount);
+    _size -= amount;
+    return tail;
+  }
+
+  /*!
+   * @brief Fills an empty archetype with rows whose columns are copied from chunk images,
+   * used for restoring snapshots
+   * @param new_entities The entities of the rows, in row order
+   * @param images The chunk images of each column, in column order
+   */
+  void load_rows(std::span<const EntityId> new_entities, std::span<const uint8_t* const> images) {
+    if (_size != 0 || images.size() != components.size()) {
+      throw std::exception();
+    }
+    for (std::size_t i = 0; i < components.size(); ++i) {
+      components[i].load(images[i], new_entities.size());
+    }
+    entities.assign(new_entities.begin(), new_entities.end());
+    _size = new_entities.size();
+  }
+
+  /*! @brief Returns the entity stored in a row */
+  EntityId get_entity(std::size_t row) { return entities[row]; }
+
+  /*! @brief Returns the entities of a range of rows */
+  std::span<const EntityId> get_entities(std::size_t row, std::size_t amount) {
+    return std::span<const EntityId>(entities).subspan(row, amount);
+  }
+
+  /*! @brief Returns the amount of chunks the rows are split into */
+  std::size_t chunk_count() {
+    return (_size + Column::chunk_rows - 1) / Column::chunk_rows;
+  }
+
+  /*! @brief Returns the amount of rows in a chunk */
+  std::size_t chunk_size(std::size_t chunk) {
+    return std::min(Column::chunk_rows, _size - chunk * Column::chunk_rows);
+  }
+
   /*! @brief Returns the index of the Component in signature */
-  const std::size_t column_value(ComponentId component) const {
-    auto result = std::find(type.begin(), type.end(), component);
-    if (result == type.end()) {
+  std::size_t column_value(ComponentId component) const {
+    if (component >= column_table.size() || column_table[component] == no_column) {
       throw std::exception();
     }
-    auto index = std::distance(type.begin(), result);
-    return index;
+    return column_table[component];
   }
 
   /*! @brief Creates a new Column with a certain type */
   void create_column(std::size_t element_size, ComponentId type) {
-    components.push_back(Column(element_size, type));
+    components.push_back(Column(element_size, type, chunk_resource, index_resource));
+  }
+
+  /*! @brief Creates a new Column with the lifecycle of a component */
+  void create_column(const ComponentInfo &info, ComponentId type) {
+    components.push_back(Column(info, type, chunk_resource, index_resource));
+  }
+
+  /*!
+   * @brief Destroys the non trivial components without giving any memory back, for a registry
+   * that is about to release its resources as a whole
+   */
+  void abandon() {
+    for (Column &column: components) {
+      column.abandon();
+    }
   }
 
   /*! @brief Archetype Destructor */
@@ -85,24 +297,37 @@ private:
   /*! @brief Id representation */
   ArchetypeId id;
   /*! @brief Component archetype representation */
-  ArchetypeSignature type;
+  std::pmr::vector<ComponentId> type;
+  /*! @brief Sorted copy of the signature, used for matching queries */
+  std::pmr::vector<ComponentId> sorted_type;
+  /*! @brief Bitmask of the components, used for matching queries */
+  ComponentMask mask;
+  /*! @brief Marks the components without a column in the column table */
+  static constexpr uint16_t no_column { UINT16_MAX };
+  /*! @brief Column of each component id (up to the largest one of the signature), no_column when missing */
+  std::pmr::vector<uint16_t> column_table;
+  /*! @brief Back reference from each row to the entity stored in it */
+  std::pmr::vector<EntityId> entities;
+  /*! @brief Resource the chunks of the columns are allocated from */
+  std::pmr::memory_resource *chunk_resource;
+  /*! @brief Resource the chunk tables of the columns are allocated from */
+  std::pmr::memory_resource *index_resource;
   /*! @brief Vector that stores the columns that represent the array of components */
-  std::vector<Column> components;
-  /*! @brief Graph edges for other archetypes */
-  std::map<ComponentId, std::shared_ptr<ArchetypeEdge>> edges;
-};
-
-/*! @brief Connections to other Archetypes */
-struct ArchetypeEdge {
-  std::tuple<std::shared_ptr<Archetype>, ComponentId> add;
-  std::tuple<std::shared_ptr<Archetype>, ComponentId> remove;
+  std::pmr::vector<Column> components;
+  /*! @brief Graph edges for other archetypes, a flat vector sorted by component */
+  std::pmr::vector<ArchetypeEdge> edges;
 };
 
 /*! @brief The Record is an archetype relation with its row on the database */
 struct Record {
-  std::shared_ptr<Archetype> archetype;
+  Archetype *archetype { nullptr };
   std::size_t row;
+  /*! @brief Handle currently living in the slot, 0 when the slot is free */
+  EntityId entity { 0 };
 };
 
-/* @brief Alias for Archetype pointer */
-using archetype_t = std::shared_ptr<Archetype>;
+/*!
+ * @brief Alias for Archetype pointer, the archetypes are owned by the archetype table of
+ * their registry and stay at the same address until they are destroyed
+ */
+using archetype_t = Archetype*;
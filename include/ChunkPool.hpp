@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+/*!
+ * @brief Memory resource for the chunks of the columns. Chunks only come in a few sizes (one per
+ * component layout), so the pool keeps a free list per size and alignment and carves new blocks
+ * out of slabs taken from the upstream resource. Freed chunks are reused by the next column that
+ * grows, and release() gives the slabs back at once. It is not synchronized: chunks are only
+ * allocated and freed by structural changes, which the registry applies from one thread
+ */
+class ChunkPool : public std::pmr::memory_resource {
+public:
+  /*! @brief Target size of a slab, a slab holds at least one block */
+  static constexpr std::size_t slab_bytes { 1 << 20 };
+
+  /*! @brief Creates an empty pool over an upstream resource */
+  explicit ChunkPool(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : upstream{upstream} {};
+
+  ChunkPool(const ChunkPool &) = delete;
+  ChunkPool &operator=(const ChunkPool &) = delete;
+
+  /*! @brief Releases the slabs */
+  ~ChunkPool() override { release(); }
+
+  /*! @brief Gives every slab back to the upstream resource, the blocks handed out become invalid */
+  void release();
+
+  /*! @brief Returns the resource the slabs are taken from */
+  std::pmr::memory_resource *upstream_resource() const { return upstream; }
+
+  /*! @brief Returns the bytes of the slabs taken from the upstream resource */
+  std::size_t reserved_bytes() const { return reserved; }
+
+  /*! @brief Returns the bytes of the slabs that are not handed out (free lists and slab tails) */
+  std::size_t free_bytes() const { return reserved - handed_out; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+  void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  /*! @brief Blocks of one size and alignment */
+  struct Pool {
+    /*! @brief Head of the free list, the link is stored in the first bytes of each free block */
+    void *free { nullptr };
+    /*! @brief Next never used block of the last slab */
+    std::byte *next { nullptr };
+    /*! @brief End of the last slab */
+    std::byte *end { nullptr };
+    /*! @brief Slabs taken from the upstream resource */
+    std::vector<std::byte*> slabs;
+    /*! @brief Bytes of each slab */
+    std::size_t slab_size { 0 };
+  };
+
+  /*! @brief Returns the size of a block holding the requested bytes (at least a free list link) */
+  static std::size_t block_size(std::size_t bytes, std::size_t alignment);
+
+  /*! @brief The resource the slabs are taken from */
+  std::pmr::memory_resource *upstream;
+  /*! @brief Pools by block size and alignment */
+  std::map<std::pair<std::size_t, std::size_t>, Pool> pools;
+  /*! @brief Bytes of the slabs */
+  std::size_t reserved { 0 };
+  /*! @brief Bytes of the blocks currently handed out */
+  std::size_t handed_out { 0 };
+};
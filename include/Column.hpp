@@ -1,19 +1,186 @@
 #pragma once
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <cstring>
 #include <iostream>
 #include <span>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "AlignedSpan.hpp"
+#include "ComponentInfo.hpp"
 #include "Types.hpp"
 
 /*!
  * @brief Database Columns that represent components (vertically), the row is a representation
- * of an entity
+ * of an entity. The rows are stored in fixed size chunks that are allocated on demand,
+ * so a column only pays for the rows it holds. Trivially copyable components are handled
+ * as raw bytes, the others are constructed, moved and destroyed through their ComponentInfo.
+ * Split components (ECS_SPLIT_COMPONENT) keep one array per field in each chunk, so a chunk
+ * holds field 0 of every row, then field 1 of every row, and so on. The chunks are taken
+ * from a memory resource (the chunk pool of the registry)
  */
 class Column {
 public:
-  Column(std::size_t element_size, ComponentId type) : element_size{ element_size }, type{ type }
-   {};
+  /*! @brief Amount of rows in a chunk (power of two, shared by every column of an archetype) */
+  static constexpr std::size_t chunk_rows { 1024 };
+  /*! @brief Minimum alignment of the chunk buffers (cache line), raised to alignof(T) when larger */
+  static constexpr std::size_t chunk_alignment { simd_alignment };
+
+  /*!
+   * @brief Creates a column of a component
+   * @param resource Resource the chunks are allocated from
+   * @param table_resource Resource the chunk table and the field layout are allocated from
+   */
+  Column(const ComponentInfo &info, ComponentId type,
+         std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+         std::pmr::memory_resource *table_resource = std::pmr::get_default_resource())
+    : info{ info }, element_size{ info.size }, type{ type }, alignment{ std::max(chunk_alignment, info.alignment) },
+      resource{ resource }, field_arrays{ table_resource }, chunks{ table_resource } {
+    for (std::size_t f = 0; f < info.fields_count; ++f) {
+      field_arrays.push_back(chunk_bytes);
+      chunk_bytes += (info.fields[f].size * chunk_rows + alignment - 1) & ~(alignment - 1);
+    }
+    if (info.fields_count == 0) {
+      chunk_bytes = (element_size * chunk_rows + alignment - 1) & ~(alignment - 1);
+    }
+  };
+
+  /*! @brief Creates a column of trivially copyable components of a given size */
+  Column(std::size_t element_size, ComponentId type,
+         std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+         std::pmr::memory_resource *table_resource = std::pmr::get_default_resource())
+    : Column(ComponentInfo::trivial(element_size), type, resource, table_resource) {};
+
+  Column(const Column &) = delete;
+  Column &operator=(const Column &) = delete;
+
+  Column(Column &&other) noexcept : info{ other.info }, element_size{ other.element_size }, type{ other.type },
+    alignment{ other.alignment }, resource{ other.resource }, chunk_bytes{ other.chunk_bytes },
+    field_arrays{ std::move(other.field_arrays) },
+    count{ other.count }, chunks{ std::move(other.chunks) } {
+    other.count = 0;
+  }
+
+  Column &operator=(Column &&other) noexcept {
+    if (this != &other) {
+      destroy_range(0, count);
+      info = other.info;
+      element_size = other.element_size;
+      type = other.type;
+      alignment = other.alignment;
+      resource = other.resource;
+      chunk_bytes = other.chunk_bytes;
+      field_arrays = std::move(other.field_arrays);
+      count = other.count;
+      chunks = std::move(other.chunks);
+      other.count = 0;
+    }
+    return *this;
+  }
+
+  /*! @brief Destroys the components left in the column */
+  ~Column() {
+    destroy_range(0, count);
+  }
+
+  /*!
+   * @brief Destroys the components left in the column without giving the chunks back,
+   * for a registry that is about to release its resources as a whole
+   */
+  void abandon() {
+    destroy_range(0, count);
+    count = 0;
+  }
+
+  /*! @brief Returns the lifecycle of the stored component */
+  const ComponentInfo &get_info() const {
+    return info;
+  }
+
+  /*! @brief Returns the alignment of the chunks */
+  std::size_t get_alignment() const {
+    return alignment;
+  }
+
+  /*! @brief Returns the size in bytes of a chunk */
+  std::size_t get_chunk_bytes() const {
+    return chunk_bytes;
+  }
+
+  /*!
+   * @brief Copies a whole chunk (every array) to a buffer of chunk_bytes, the rows past the
+   * end of the column are zeroed
+   * @param chunk The index of the chunk
+   * @param image The buffer receiving the chunk
+   */
+  void copy_chunk(std::size_t chunk, uint8_t *image) {
+    std::size_t rows { chunk_size(chunk) };
+    if (rows < chunk_rows) {
+      memset(image, 0, chunk_bytes);
+    }
+    for (std::size_t f = 0; f < arrays(); ++f) {
+      std::size_t offset { is_split() ? field_arrays[f] : 0 };
+      memcpy(image + offset, chunks[chunk].get() + offset, rows * field_size(f));
+    }
+  }
+
+  /*!
+   * @brief Fills an empty column from whole chunk images (as written by copy_chunk), with one
+   * copy per chunk. Only for trivially copyable components
+   * @param images The chunk images, chunk_bytes each
+   * @param rows The amount of rows held by the images
+   */
+  void load(const uint8_t *images, std::size_t rows) {
+    if (count != 0 || !info.trivially_relocatable) {
+      throw std::exception();
+    }
+    std::size_t needed { (rows + chunk_rows - 1) / chunk_rows };
+    chunks.reserve(needed);
+    for (std::size_t chunk = 0; chunk < needed; ++chunk) {
+      chunks.push_back(allocate_chunk());
+      memcpy(chunks.back().get(), images + chunk * chunk_bytes, chunk_bytes);
+    }
+    count = rows;
+  }
+
+  /*! @brief Returns the bytes of the allocated chunks */
+  std::size_t reserved_bytes() const {
+    return chunks.size() * chunk_bytes;
+  }
+
+  /*! @brief Returns the bytes of the occupied rows */
+  std::size_t used_bytes() const {
+    if (!is_split()) {
+      return count * element_size;
+    }
+    std::size_t row_bytes { 0 };
+    for (std::size_t f = 0; f < info.fields_count; ++f) {
+      row_bytes += info.fields[f].size;
+    }
+    return count * row_bytes;
+  }
+
+  /*! @brief Returns the bytes of the chunk table and the field layout */
+  std::size_t overhead_bytes() const {
+    return chunks.capacity() * sizeof(chunk_t) + field_arrays.capacity() * sizeof(std::size_t);
+  }
+
+  /*! @brief Returns true if the component is stored field by field */
+  bool is_split() const {
+    return info.fields_count > 0;
+  }
+
+  /*!
+   * @brief Returns the start of a field array in a chunk of a split column
+   * @param chunk The index of the chunk
+   * @param field The position of the field in the field list
+   */
+  uint8_t *field_data(std::size_t chunk, std::size_t field) {
+    return chunks[chunk].get() + field_arrays[field];
+  }
 
   /*!
    * @brief Overload of the indexing operator for selecting a line (Archetype)
@@ -21,15 +188,23 @@ public:
    */
   template <typename T>
   T get(std::size_t index) {
-    T (*array)[max_amount] = (T(*)[max_amount]) elements.get();
-    return (*array)[index];
+    if constexpr (is_split_component_v<T>) {
+      T value {};
+      read(index, &value);
+      return value;
+    } else {
+      return *static_cast<T*>(get(index));
+    }
   }
 
-  /*! @brief Return the span of the current occupied column */
+  /*!
+   * @brief Return the span of the occupied part of a chunk
+   * @param chunk The index of the chunk
+   */
   template <typename T>
-  std::pair<void*, std::size_t> get_vector() {
-    void* array = &elements.get()[0];
-    return std::make_pair(array, count);
+  std::pair<void*, std::size_t> get_vector(std::size_t chunk) {
+    void* array = chunks[chunk].get();
+    return std::make_pair(array, chunk_size(chunk));
   }
 
   /*! @brief Return the current size of the column */
@@ -37,12 +212,147 @@ public:
     return count;
   }
 
+  /*! @brief Returns the amount of allocated chunks */
+  std::size_t chunk_count() {
+    return chunks.size();
+  }
+
+  /*! @brief Returns the amount of occupied rows in a chunk */
+  std::size_t chunk_size(std::size_t chunk) {
+    if (chunk + 1 < chunks.size())
+      return chunk_rows;
+    return count - chunk * chunk_rows;
+  }
+
   /*!
-   * @brief Overload of the indexing operator for selecting a line (Archetype)
+   * @brief Overload of the indexing operator for selecting a line (Archetype). A row of a
+   * split column is not addressable, the pointer is the row in the first field array (strided
+   * by the size of that field)
    * @param index Return the value from the buffer of components
    */
   void *get(std::size_t index) {
-    return &elements.get()[index * element_size];
+    if (is_split()) {
+      return address(index, 0);
+    }
+    return &chunks[index / chunk_rows].get()[(index % chunk_rows) * element_size];
+  }
+
+  /*!
+   * @brief Copies a component out of the column, gathering the fields of split columns
+   * @param index Index of the component in the column
+   * @param component Constructed component that receives the value
+   */
+  void read(std::size_t index, void *component) {
+    if (is_split()) {
+      for (std::size_t f = 0; f < info.fields_count; ++f) {
+        memcpy(static_cast<uint8_t*>(component) + info.fields[f].offset, address(index, f), info.fields[f].size);
+      }
+    } else if (info.trivially_relocatable) {
+      memcpy(component, get(index), element_size);
+    } else {
+      info.copy_assign(component, get(index));
+    }
+  }
+
+  /*!
+   * @brief Copies a component into the column, scattering the fields of split columns
+   * @param index Index of the component in the column
+   * @param component The value to be copied
+   */
+  void write(std::size_t index, const void *component) {
+    if (is_split()) {
+      for (std::size_t f = 0; f < info.fields_count; ++f) {
+        memcpy(address(index, f), static_cast<const uint8_t*>(component) + info.fields[f].offset, info.fields[f].size);
+      }
+    } else if (info.trivially_relocatable) {
+      memcpy(get(index), component, element_size);
+    } else {
+      info.copy_assign(get(index), component);
+    }
+  }
+
+  /*!
+   * @brief Appends a new row at the end of the column, zeroed or default constructed
+   * @return The index of the new row
+   */
+  std::size_t push_back() {
+    if (count == chunks.size() * chunk_rows) {
+      chunks.push_back(allocate_chunk());
+    }
+    ++count;
+    if (info.trivially_relocatable) {
+      zero_range(count - 1, 1);
+    } else {
+      info.construct(get(count - 1));
+    }
+    return count - 1;
+  }
+
+  /*!
+   * @brief Appends zeroed (or default constructed) rows at the end of the column, allocating
+   * the chunks at once
+   * @param amount The amount of rows to be appended
+   * @return The index of the first new row
+   */
+  std::size_t push_back(std::size_t amount) {
+    std::size_t first { grow(amount) };
+    if (info.trivially_relocatable) {
+      zero_range(first, amount);
+    } else {
+      for_each_range(first, amount, [&] (uint8_t *dst, std::size_t, std::size_t rows) {
+        for (std::size_t i = 0; i < rows; ++i) {
+          info.construct(dst + i * element_size);
+        }
+      });
+    }
+    return first;
+  }
+
+  /*!
+   * @brief Appends rows moved from another column of the same component. Trivially relocatable
+   * rows are copied with one memcpy per chunk piece, the others are move constructed in the new
+   * rows, leaving the source rows moved-from
+   * @param source The column the rows are moved from
+   * @param source_index Index of the first row in the source
+   * @param amount The amount of rows to be appended
+   * @return The index of the first new row
+   */
+  std::size_t append(Column &source, std::size_t source_index, std::size_t amount) {
+    if (source_index + amount > source.count) {
+      throw std::exception();
+    }
+    std::size_t first { grow(amount) };
+    if (info.trivially_relocatable) {
+      insert(source, source_index, first, amount);
+    } else {
+      for_each_range(first, amount, [&] (uint8_t *dst, std::size_t offset, std::size_t rows) {
+        for (std::size_t i = 0; i < rows; ++i) {
+          info.move_construct(dst + i * element_size, source.get(source_index + offset + i));
+        }
+      });
+    }
+    return first;
+  }
+
+  /*!
+   * @brief Removes the last row of the column, releasing its chunk when it gets empty
+   */
+  void pop_back() {
+    destroy_range(count - 1, 1);
+    --count;
+    if (count == (chunks.size() - 1) * chunk_rows) {
+      chunks.pop_back();
+    }
+  }
+
+  /*!
+   * @brief Removes the last rows of the column, releasing the chunks that get empty
+   * @param amount The amount of rows to be removed
+   */
+  void pop_back(std::size_t amount) {
+    destroy_range(count - amount, amount);
+    count -= amount;
+    chunks.resize((count + chunk_rows - 1) / chunk_rows);
   }
 
   /*!
@@ -52,44 +362,279 @@ public:
    */
   template <typename Component>
   std::size_t insert(Component component, std::size_t index) {
-    if ( count == max_amount ) {
+    if ( index >= count ) {
       throw std::exception();
     }
-    Component (*array)[max_amount] = (Component(*)[max_amount]) (elements.get());
-    (*array)[index] = component;
-    count++;
-    return count - 1;
+    if constexpr (is_split_component_v<Component>) {
+      write(index, &component);
+    } else {
+      *static_cast<Component*>(get(index)) = std::move(component);
+    }
+    return index;
   }
 
   /*!
-   * @brief Inserts value in the column
+   * @brief Inserts value in the column, copying it
    * @param component Pointer to the component be inserted
    * @param index Index of the component in the column
    */
   std::size_t insert(void *component, std::size_t index) {
-    memcpy(&elements.get()[index * element_size], component, element_size);
-    count++;
-    return count - 1;
+    if ( index >= count ) {
+      throw std::exception();
+    }
+    write(index, component);
+    return index;
+  }
+
+  /*!
+   * @brief Moves a value into the column, leaving it moved-from. Used for values owned by
+   * the registry (command buffers), so move only components can be recorded
+   * @param component Pointer to the component to be moved
+   * @param index Index of the component in the column
+   */
+  std::size_t move_in(void *component, std::size_t index) {
+    if ( index >= count ) {
+      throw std::exception();
+    }
+    if (info.trivially_relocatable) {
+      write(index, component);
+    } else {
+      info.move_assign(get(index), component);
+    }
+    return index;
+  }
+
+  /*!
+   * @brief Copies a contiguous buffer of components into a range of rows, one memcpy per chunk
+   * @param components Pointer to the first component to be copied
+   * @param index Index of the first row
+   * @param amount Amount of components to be copied
+   */
+  void insert(const void *components, std::size_t index, std::size_t amount) {
+    if ( index + amount > count ) {
+      throw std::exception();
+    }
+    const uint8_t *src { static_cast<const uint8_t*>(components) };
+    if (is_split()) {
+      for (std::size_t f = 0; f < info.fields_count; ++f) {
+        const FieldInfo &field { info.fields[f] };
+        for_each_piece(index, amount, [&] (std::size_t row, std::size_t offset, std::size_t rows) {
+          uint8_t *dst { address(row, f) };
+          for (std::size_t i = 0; i < rows; ++i) {
+            memcpy(dst + i * field.size, src + (offset + i) * element_size + field.offset, field.size);
+          }
+        });
+      }
+      return;
+    }
+    for_each_range(index, amount, [&] (uint8_t *dst, std::size_t offset, std::size_t rows) {
+      if (info.trivially_relocatable) {
+        memcpy(dst, src + offset * element_size, rows * element_size);
+      } else {
+        for (std::size_t i = 0; i < rows; ++i) {
+          info.copy_assign(dst + i * element_size, src + (offset + i) * element_size);
+        }
+      }
+    });
   }
 
   /*!
-   * @brief Removes value from the column
+   * @brief Transfers a range of rows from another column of the same component, one memcpy
+   * per chunk piece. Non trivial components are moved, leaving the source rows moved-from
+   * @param source The column the rows are transferred from
+   * @param source_index Index of the first row in the source
+   * @param index Index of the first row in this column
+   * @param amount Amount of rows to be copied
+   */
+  void insert(Column &source, std::size_t source_index, std::size_t index, std::size_t amount) {
+    if ( index + amount > count || source_index + amount > source.count ) {
+      throw std::exception();
+    }
+    std::size_t offset { 0 };
+    while (offset < amount) {
+      std::size_t from { source_index + offset };
+      std::size_t to { index + offset };
+      std::size_t rows { std::min({ amount - offset, chunk_rows - from % chunk_rows, chunk_rows - to % chunk_rows }) };
+      if (info.trivially_relocatable) {
+        for (std::size_t f = 0; f < arrays(); ++f) {
+          memcpy(address(to, f), source.address(from, f), rows * field_size(f));
+        }
+      } else {
+        for (std::size_t i = 0; i < rows; ++i) {
+          info.move_assign(get(to + i), source.get(from + i));
+        }
+      }
+      offset += rows;
+    }
+  }
+
+  /*!
+   * @brief Removes a range of rows, moving the last rows of the column into the hole
+   * @param index Index of the first removed row
+   * @param amount Amount of removed rows
+   */
+  void delete_components(std::size_t index, std::size_t amount) {
+    std::size_t tail { std::min(amount, count - index - amount) };
+    if (tail > 0) {
+      insert(*this, count - tail, index, tail);
+    }
+    pop_back(amount);
+  }
+
+  /*!
+   * @brief Calls a function for every chunk piece of a range of rows
+   * @param index Index of the first row
+   * @param amount Amount of rows
+   * @param fn Receives the pointer to the piece, its offset in the range and its amount of rows
+   */
+  template <typename Func>
+  void for_each_range(std::size_t index, std::size_t amount, Func fn) {
+    for_each_piece(index, amount, [&] (std::size_t row, std::size_t offset, std::size_t rows) {
+      fn(static_cast<uint8_t*>(get(row)), offset, rows);
+    });
+  }
+
+  /*!
+   * @brief Removes value from the column, moving the last row into its place
    * @param index The index of the component to be deleted
    */
   void delete_component(std::size_t index) {
-    if (index == count + 1)
-      count --;
+    if (index != count - 1) {
+      if (info.trivially_relocatable) {
+        for (std::size_t f = 0; f < arrays(); ++f) {
+          memcpy(address(index, f), address(count - 1, f), field_size(f));
+        }
+      } else {
+        info.move_assign(get(index), get(count - 1));
+      }
+    }
+    pop_back();
   }
 
 private:
+  /*!
+   * @brief Adds rows at the end of the column without initializing them, allocating the
+   * chunks at once
+   * @return The index of the first new row
+   */
+  std::size_t grow(std::size_t amount) {
+    std::size_t first { count };
+    std::size_t needed { (count + amount + chunk_rows - 1) / chunk_rows };
+    chunks.reserve(needed);
+    while (chunks.size() < needed) {
+      chunks.push_back(allocate_chunk());
+    }
+    count += amount;
+    return first;
+  }
+
+  /*! @brief Gives a chunk back to the resource it was allocated from */
+  struct ChunkDeleter {
+    std::pmr::memory_resource *resource { nullptr };
+    std::size_t bytes { 0 };
+    std::size_t alignment { chunk_alignment };
+
+    void operator()(uint8_t *chunk) const {
+      resource->deallocate(chunk, bytes, alignment);
+    }
+  };
+
+  /*! @brief Alias for an owned chunk buffer */
+  using chunk_t = std::unique_ptr<uint8_t[], ChunkDeleter>;
+
+  /*! @brief Calls fn(first row, offset in the range, amount of rows) for every chunk piece of a range */
+  template <typename Func>
+  void for_each_piece(std::size_t index, std::size_t amount, Func fn) {
+    std::size_t offset { 0 };
+    while (offset < amount) {
+      std::size_t row { index + offset };
+      std::size_t rows { std::min(amount - offset, chunk_rows - row % chunk_rows) };
+      fn(row, offset, rows);
+      offset += rows;
+    }
+  }
+
+  /*! @brief Returns the amount of arrays of a chunk (one, or one per field when split) */
+  std::size_t arrays() const {
+    return is_split() ? info.fields_count : 1;
+  }
+
+  /*! @brief Returns the size of the elements of an array of a chunk */
+  std::size_t field_size(std::size_t field) const {
+    return is_split() ? info.fields[field].size : element_size;
+  }
+
+  /*! @brief Returns the address of a row in an array of a chunk */
+  uint8_t *address(std::size_t row, std::size_t field) {
+    if (is_split()) {
+      return chunks[row / chunk_rows].get() + field_arrays[field] + (row % chunk_rows) * info.fields[field].size;
+    }
+    return static_cast<uint8_t*>(get(row));
+  }
+
+  /*! @brief Zeroes a range of rows of trivially copyable components */
+  void zero_range(std::size_t index, std::size_t amount) {
+    for (std::size_t f = 0; f < arrays(); ++f) {
+      for_each_piece(index, amount, [&] (std::size_t row, std::size_t, std::size_t rows) {
+        memset(address(row, f), 0, rows * field_size(f));
+      });
+    }
+  }
+
+  /*! @brief Destroys a range of rows of non trivial components, the rows stay allocated */
+  void destroy_range(std::size_t index, std::size_t amount) {
+    if (info.trivially_relocatable) {
+      return;
+    }
+    for_each_range(index, amount, [&] (uint8_t *ptr, std::size_t, std::size_t rows) {
+      for (std::size_t i = 0; i < rows; ++i) {
+        info.destroy(ptr + i * element_size);
+      }
+    });
+  }
+
+  /*! @brief Allocates a new cache aligned chunk */
+  chunk_t allocate_chunk() {
+    return chunk_t { static_cast<uint8_t*>(resource->allocate(chunk_bytes, alignment)),
+                     ChunkDeleter { resource, chunk_bytes, alignment } };
+  }
+
+  /*! @brief Lifecycle of the component */
+  ComponentInfo info;
   /*! @brief Size of an element */
   std::size_t element_size;
-  /*! @brief Number of elements */
-  std::size_t count { 0 };
-  /*! @brief Max amount of elements in the array */
-  static constexpr std::size_t max_amount { 100000 };
-  /*! @brief Buffer with the components */
-  std::unique_ptr<uint8_t[]> elements {new uint8_t [max_amount * element_size]};
   /*! @brief the type of component in the column */
   ComponentId type;
+  /*! @brief Alignment of the chunks and of the field arrays in them */
+  std::size_t alignment;
+  /*! @brief Resource the chunks are allocated from */
+  std::pmr::memory_resource *resource;
+  /*! @brief Size in bytes of a chunk (padded to the alignment) */
+  std::size_t chunk_bytes { 0 };
+  /*! @brief Offset of each field array in the chunks of a split column */
+  std::pmr::vector<std::size_t> field_arrays;
+  /*! @brief Number of elements */
+  std::size_t count { 0 };
+  /*! @brief Buffers with the components, each one holding chunk_rows elements */
+  std::pmr::vector<chunk_t> chunks;
 };
+
+/*!
+ * @brief Returns the occupied part of a chunk of a column as a std::span, or as field spans
+ * for split components
+ * @param column The column of the component
+ * @param chunk The index of the chunk
+ */
+template <typename T>
+chunk_span_t<T> make_chunk_span(Column &column, std::size_t chunk) {
+  std::size_t rows { column.chunk_size(chunk) };
+  if constexpr (is_split_component_v<T>) {
+    std::array<uint8_t*, split_field_count<T>()> arrays;
+    for (std::size_t f = 0; f < arrays.size(); ++f) {
+      arrays[f] = column.field_data(chunk, f);
+    }
+    return FieldSpans<T>(arrays, rows);
+  } else {
+    return std::span<T>(static_cast<T*>(column.template get_vector<T>(chunk).first), rows);
+  }
+}
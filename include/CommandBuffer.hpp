@@ -0,0 +1,210 @@
+#pragma once
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "IdController.hpp"
+#include "Types.hpp"
+
+/*! @brief Kind of structural change recorded in a command buffer */
+enum class CommandType { spawn, despawn, add, remove, set };
+
+/*! @brief A recorded structural change */
+struct Command {
+  CommandType type;
+  /*! @brief The target entity (unused by spawn) */
+  EntityId entity;
+  /*! @brief The component of add, remove and set */
+  ComponentId component;
+  /*! @brief Offset of the value in the data buffer, or first spawn component for spawn */
+  std::size_t offset;
+  /*! @brief Amount of components of a spawn */
+  std::size_t amount;
+};
+
+/*! @brief A component value of a spawn command */
+struct SpawnComponent {
+  ComponentId component;
+  std::size_t offset;
+};
+
+/*!
+ * @brief Where commands are recorded from: a chunk of a system, or the default value outside
+ * of systems. Flushes apply the commands in the order of their origins, which does not depend
+ * on the thread that ran the chunk
+ */
+struct CommandOrigin {
+  SystemId system { 0 };
+  ArchetypeId archetype { 0 };
+  std::size_t chunk { 0 };
+
+  auto operator<=>(const CommandOrigin &) const = default;
+};
+
+/*! @brief Commands of a buffer recorded from the same origin, from a first command on */
+struct CommandRun {
+  CommandOrigin origin;
+  std::size_t first;
+};
+
+/*!
+ * @brief Records structural changes (spawn, despawn, add, remove, set) so they can be made
+ * while systems iterate. The registry applies every buffer at once in a flush, grouping the
+ * entities by source and destination archetype. Each thread must record in its own buffer
+ */
+class CommandBuffer {
+public:
+  /*! @brief Creates a buffer that resolves the component ids with the controller */
+  CommandBuffer(IdController &id_controller) : ids{id_controller} {};
+
+  /*!
+   * @brief Records the creation of an entity with its initial components
+   * @param components The values of the components of the new entity
+   */
+  template <typename ...Components>
+  void spawn(Components ...components) {
+    std::size_t first { spawn_components.size() };
+    ([&] {
+      spawn_components.push_back(SpawnComponent { ids.get_component_id<Components>(), store(std::move(components)) });
+    } (), ...);
+    record(Command { CommandType::spawn, 0, 0, first, sizeof...(Components) });
+  }
+
+  /*! @brief Records the deletion of an entity */
+  void despawn(EntityId entity) {
+    record(Command { CommandType::despawn, entity, 0, 0, 0 });
+  }
+
+  /*!
+   * @brief Records the addition of a component to an entity
+   * @param value The initial value of the component
+   */
+  template <typename T>
+  void add(EntityId entity, T value = T {}) {
+    record(Command { CommandType::add, entity, ids.get_component_id<T>(), store(std::move(value)), 0 });
+  }
+
+  /*! @brief Records the removal of a component from an entity */
+  template <typename T>
+  void remove(EntityId entity) {
+    record(Command { CommandType::remove, entity, ids.get_component_id<T>(), 0, 0 });
+  }
+
+  /*!
+   * @brief Records a new value for a component, ignored if the entity does not have
+   * the component after the structural changes
+   */
+  template <typename T>
+  void set(EntityId entity, T value) {
+    record(Command { CommandType::set, entity, ids.get_component_id<T>(), store(std::move(value)), 0 });
+  }
+
+  /*! @brief Returns the recorded commands */
+  const std::vector<Command> &get_commands() const { return commands; }
+
+  /*! @brief Returns the runs of commands recorded from the same origin, in recording order */
+  const std::vector<CommandRun> &get_runs() const { return runs; }
+
+  /*! @brief Returns the origin of the commands recorded by the calling thread */
+  static CommandOrigin &current_origin() {
+    thread_local CommandOrigin origin {};
+    return origin;
+  }
+
+  /*! @brief Returns the components of a spawn command */
+  const SpawnComponent *get_spawn_components(const Command &command) const {
+    return &spawn_components[command.offset];
+  }
+
+  /*! @brief Returns the stored value at an offset, the flush moves it into its row */
+  void *get_data(std::size_t offset) {
+    if (offset & boxed_flag) {
+      return boxes[offset & ~boxed_flag].get();
+    }
+    return &data[offset];
+  }
+
+  /*! @brief Returns the bytes reserved by the buffer (the recorded values and commands) */
+  std::size_t memory_bytes() const {
+    return commands.capacity() * sizeof(Command) + runs.capacity() * sizeof(CommandRun)
+           + spawn_components.capacity() * sizeof(SpawnComponent) + data.capacity() + boxes.capacity() * sizeof(box_t);
+  }
+
+  /*! @brief Returns true if nothing was recorded */
+  bool empty() const { return commands.empty(); }
+
+  /*! @brief Drops the recorded commands, keeping the memory */
+  void clear() {
+    commands.clear();
+    runs.clear();
+    spawn_components.clear();
+    data.clear();
+    boxes.clear();
+  }
+
+private:
+  /*! @brief Owned copy of a non trivial value */
+  using box_t = std::unique_ptr<void, void(*)(void*)>;
+
+  /*! @brief Marks the offsets that index the boxed values instead of the data buffer */
+  static constexpr std::size_t boxed_flag { std::size_t { 1 } << (sizeof(std::size_t) * 8 - 1) };
+
+  /*! @brief Appends a command, starting a new run when the origin of the thread changed */
+  void record(Command command) {
+    const CommandOrigin &origin { current_origin() };
+    if (runs.empty() || runs.back().origin != origin) {
+      runs.push_back(CommandRun { origin, commands.size() });
+    }
+    commands.push_back(command);
+  }
+
+  /*!
+   * @brief Copies a value into the data buffer and returns its offset. Values that are not
+   * trivially copyable can not live in a growing byte buffer, so they are boxed on the heap
+   */
+  template <typename T>
+  std::size_t store(T value) {
+    if constexpr (!std::is_trivially_copyable_v<T>) {
+      boxes.push_back(box_t { new T(std::move(value)), [] (void *ptr) { delete static_cast<T*>(ptr); } });
+      return (boxes.size() - 1) | boxed_flag;
+    } else {
+      std::size_t offset { data.size() };
+      data.resize(offset + sizeof(T));
+      memcpy(&data[offset], &value, sizeof(T));
+      return offset;
+    }
+  }
+
+  /*! @brief The id controller (used for getting the component ids) */
+  IdController &ids;
+  /*! @brief The recorded commands in order */
+  std::vector<Command> commands;
+  /*! @brief The runs of commands with the same origin */
+  std::vector<CommandRun> runs;
+  /*! @brief The components of the spawn commands */
+  std::vector<SpawnComponent> spawn_components;
+  /*! @brief Bytes of the recorded values */
+  std::vector<uint8_t> data;
+  /*! @brief The recorded values that are not trivially copyable */
+  std::vector<box_t> boxes;
+};
+
+/*! @brief Sets the origin of the commands recorded by the calling thread until the end of a scope */
+class CommandScope {
+public:
+  CommandScope(CommandOrigin origin) : previous{CommandBuffer::current_origin()} {
+    CommandBuffer::current_origin() = origin;
+  }
+
+  CommandScope(const CommandScope &) = delete;
+  CommandScope &operator=(const CommandScope &) = delete;
+
+  ~CommandScope() { CommandBuffer::current_origin() = previous; }
+
+private:
+  /*! @brief The origin restored at the end of the scope */
+  CommandOrigin previous;
+};
@@ -0,0 +1,188 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include "AlignedSpan.hpp"
+
+/*! @brief Position and size of a field inside a component */
+struct FieldInfo {
+  /*! @brief Offset of the field in the component */
+  std::size_t offset;
+  /*! @brief Size of the field */
+  std::size_t size;
+};
+
+/*!
+ * @brief Field list of a component, components are stored whole (AoS) unless the trait is
+ * specialized with ECS_SPLIT_COMPONENT, then each field gets its own array in the chunks
+ */
+template <typename T>
+struct ComponentFields {
+  static constexpr bool split { false };
+};
+
+/*!
+ * @brief Declares a component stored field by field (SoA), each listed member gets its own
+ * contiguous array. Members that are not listed are not stored (value initialized when read)
+ * @code ECS_SPLIT_COMPONENT(Body, &Body::x, &Body::y, &Body::vx, &Body::vy) @endcode
+ */
+#define ECS_SPLIT_COMPONENT(Type, ...)                                   \
+  template <>                                                            \
+  struct ComponentFields<Type> {                                         \
+    static constexpr bool split { true };                                \
+    static constexpr auto members { std::make_tuple(__VA_ARGS__) };      \
+  };
+
+/*! @brief True if the component is stored field by field */
+template <typename T>
+inline constexpr bool is_split_component_v = ComponentFields<std::remove_const_t<T>>::split;
+
+/*! @brief Returns the amount of stored fields of a split component */
+template <typename T>
+constexpr std::size_t split_field_count() {
+  return std::tuple_size_v<std::remove_const_t<decltype(ComponentFields<std::remove_const_t<T>>::members)>>;
+}
+
+/*! @brief Returns the position of a member in the field list of a split component */
+template <typename T, auto Member, std::size_t I = 0>
+constexpr std::size_t field_index() {
+  using fields_t = ComponentFields<std::remove_const_t<T>>;
+  if constexpr (I >= split_field_count<T>()) {
+    static_assert(I < split_field_count<T>(), "The member is not a field of the split component");
+    return I;
+  } else if constexpr (std::is_same_v<std::tuple_element_t<I, std::remove_const_t<decltype(fields_t::members)>>, decltype(Member)>) {
+    if constexpr (std::get<I>(fields_t::members) == Member) {
+      return I;
+    } else {
+      return field_index<T, Member, I + 1>();
+    }
+  } else {
+    return field_index<T, Member, I + 1>();
+  }
+}
+
+/*! @brief Returns the offsets and sizes of the fields of a split component, computed once */
+template <typename T>
+const FieldInfo *field_layout() {
+  static const std::array<FieldInfo, split_field_count<T>()> layout { [] {
+    std::array<FieldInfo, split_field_count<T>()> fields;
+    T sample {};
+    std::size_t i { 0 };
+    std::apply([&] (auto ...members) {
+      ((fields[i++] = FieldInfo {
+          static_cast<std::size_t>(reinterpret_cast<uint8_t*>(&(sample.*members)) - reinterpret_cast<uint8_t*>(&sample)),
+          sizeof(sample.*members) }), ...);
+    }, ComponentFields<T>::members);
+    return fields;
+  } () };
+  return layout.data();
+}
+
+/*!
+ * @brief The arrays of a split component in a chunk, one span per field. Fields are reached
+ * with get<&T::member>() or by index, and whole components with load and store
+ */
+template <typename T>
+class FieldSpans {
+  using component_t = std::remove_const_t<T>;
+
+  /*! @brief Type of a member, const if the component is accessed read-only */
+  template <auto Member>
+  using member_t = std::conditional_t<std::is_const_v<T>,
+      const std::remove_reference_t<decltype(std::declval<component_t&>().*Member)>,
+      std::remove_reference_t<decltype(std::declval<component_t&>().*Member)>>;
+
+public:
+  /*! @brief Proxy of a component in the arrays, used by the per entity iteration */
+  class reference {
+  public:
+    reference(const FieldSpans *spans, std::size_t row) : spans{spans}, row{row} {};
+
+    /*! @brief Returns a field of the component */
+    template <auto Member>
+    member_t<Member> &get() const { return spans->template get<Member>()[row]; }
+
+    /*! @brief Gathers the component */
+    operator component_t() const { return spans->load(row); }
+
+    /*! @brief Scatters a component into the arrays */
+    const reference &operator=(const component_t &value) const {
+      spans->store(row, value);
+      return *this;
+    }
+
+  private:
+    const FieldSpans *spans;
+    std::size_t row;
+  };
+
+  FieldSpans() = default;
+
+  FieldSpans(const std::array<uint8_t*, split_field_count<T>()> &arrays, std::size_t rows) : arrays{arrays}, rows{rows} {};
+
+  /*! @brief Returns the amount of rows of the chunk */
+  std::size_t size() const { return rows; }
+
+  /*! @brief Returns the array of a member */
+  template <auto Member>
+  std::span<member_t<Member>> get() const {
+    return std::span<member_t<Member>>(reinterpret_cast<member_t<Member>*>(arrays[field_index<T, Member>()]), rows);
+  }
+
+  /*! @brief Returns the array of a member with its alignment, for vectorized kernels */
+  template <auto Member>
+  AlignedSpan<member_t<Member>> aligned() const {
+    return AlignedSpan<member_t<Member>>(reinterpret_cast<member_t<Member>*>(arrays[field_index<T, Member>()]), rows);
+  }
+
+  /*! @brief Returns the array of a field by its position in the field list */
+  template <std::size_t I>
+  auto field() const {
+    return get<std::get<I>(ComponentFields<component_t>::members)>();
+  }
+
+  /*! @brief Gathers the component of a row */
+  component_t load(std::size_t row) const {
+    component_t value {};
+    const FieldInfo *layout { field_layout<component_t>() };
+    for (std::size_t f = 0; f < arrays.size(); ++f) {
+      memcpy(reinterpret_cast<uint8_t*>(&value) + layout[f].offset, arrays[f] + row * layout[f].size, layout[f].size);
+    }
+    return value;
+  }
+
+  /*! @brief Scatters a component into a row */
+  void store(std::size_t row, const component_t &value) const {
+    static_assert(!std::is_const_v<T>, "The component is accessed read-only");
+    const FieldInfo *layout { field_layout<component_t>() };
+    for (std::size_t f = 0; f < arrays.size(); ++f) {
+      memcpy(arrays[f] + row * layout[f].size, reinterpret_cast<const uint8_t*>(&value) + layout[f].offset, layout[f].size);
+    }
+  }
+
+  /*! @brief Returns the proxy of a row */
+  reference operator[](std::size_t row) const { return reference(this, row); }
+
+private:
+  /*! @brief Start of each field array */
+  std::array<uint8_t*, split_field_count<T>()> arrays {};
+  /*! @brief Amount of rows */
+  std::size_t rows { 0 };
+};
+
+/*! @brief What a chunk of a component is exposed as: a span, or field spans for split components */
+template <typename T, bool Split = is_split_component_v<T>>
+struct chunk_span {
+  using type = std::span<T>;
+};
+
+template <typename T>
+struct chunk_span<T, true> {
+  using type = FieldSpans<T>;
+};
+
+template <typename T>
+using chunk_span_t = typename chunk_span<T>::type;
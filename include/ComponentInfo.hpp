@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ComponentFields.hpp"
+#include "TypeId.hpp"
+
+/*!
+ * @brief Type erased lifecycle of a component, recorded when the component is registered.
+ * Trivially relocatable components (trivially copyable) are moved with memcpy, the others
+ * go through the function pointers. Split components also carry their field layout
+ */
+struct ComponentInfo {
+  /*! @brief Size of the component */
+  std::size_t size;
+  /*! @brief Alignment of the component */
+  std::size_t alignment;
+  /*! @brief True when the component can be moved, copied and dropped as raw bytes */
+  bool trivially_relocatable;
+  /*! @brief Default constructs a component in raw memory */
+  void (*construct)(void *dst);
+  /*! @brief Move constructs a component in raw memory, used when rows migrate to another archetype */
+  void (*move_construct)(void *dst, void *src);
+  /*! @brief Copy assigns to a constructed component */
+  void (*copy_assign)(void *dst, const void *src);
+  /*! @brief Move assigns to a constructed component */
+  void (*move_assign)(void *dst, void *src);
+  /*! @brief Destroys a component */
+  void (*destroy)(void *ptr);
+  /*! @brief Layout of the stored fields of a split component, nullptr when stored whole */
+  const FieldInfo *fields;
+  /*! @brief Amount of stored fields, 0 when stored whole */
+  std::size_t fields_count;
+  /*! @brief Hash of the type name, identifies the component in snapshots (0 for plain bytes) */
+  uint64_t name_hash;
+
+  /*! @brief Returns the lifecycle of a component type */
+  template <typename T>
+  static ComponentInfo of() {
+    static_assert(std::is_default_constructible_v<T>, "Components must be default constructible");
+    static_assert(std::is_move_constructible_v<T> && std::is_move_assignable_v<T>, "Components must be movable");
+    static_assert(!is_split_component_v<T> || std::is_trivially_copyable_v<T>, "Split components must be trivially copyable");
+    const FieldInfo *fields { nullptr };
+    std::size_t fields_count { 0 };
+    if constexpr (is_split_component_v<T>) {
+      fields = field_layout<T>();
+      fields_count = split_field_count<T>();
+    }
+    return ComponentInfo {
+      sizeof(T),
+      alignof(T),
+      std::is_trivially_copyable_v<T>,
+      [] (void *dst) { new (dst) T(); },
+      [] (void *dst, void *src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+      [] (void *dst, const void *src) {
+        if constexpr (std::is_copy_assignable_v<T>) {
+          *static_cast<T*>(dst) = *static_cast<const T*>(src);
+        } else {
+          throw std::bad_function_call();
+        }
+      },
+      [] (void *dst, void *src) { *static_cast<T*>(dst) = std::move(*static_cast<T*>(src)); },
+      [] (void *ptr) { static_cast<T*>(ptr)->~T(); },
+      fields,
+      fields_count,
+      type_name_hash<T>()
+    };
+  }
+
+  /*! @brief Returns the lifecycle of a plain block of bytes */
+  static ComponentInfo trivial(std::size_t size) {
+    return ComponentInfo { size, alignof(std::max_align_t), true, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0 };
+  }
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include "Types.hpp"
+
+/*!
+ * @brief Maximum amount of component ids a mask can hold, can be raised at compile
+ * time for worlds with more component types
+ */
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 256
+#endif
+
+/*!
+ * @brief Fixed width bitset of component ids, used for testing if an archetype has every
+ * component of a query with a few AND instructions
+ * @tparam Bits The amount of component ids the mask holds
+ */
+template <std::size_t Bits>
+class BasicComponentMask {
+public:
+  /*! @brief Amount of 64 bit words of the mask */
+  static constexpr std::size_t words { (Bits + 63) / 64 };
+
+  /*! @brief Amount of component ids the mask holds */
+  static constexpr std::size_t capacity { Bits };
+
+  /*! @brief Creates an empty mask */
+  BasicComponentMask() = default;
+
+  /*! @brief Creates a mask from a list of components */
+  BasicComponentMask(const std::vector<ComponentId> &components) {
+    for (ComponentId component: components) {
+      set(component);
+    }
+  }
+
+  /*! @brief Adds a component to the mask */
+  void set(ComponentId component) { bits[component / 64] |= uint64_t { 1 } << (component % 64); }
+
+  /*! @brief Removes a component from the mask */
+  void reset(ComponentId component) { bits[component / 64] &= ~(uint64_t { 1 } << (component % 64)); }
+
+  /*! @brief Returns true if the component is in the mask */
+  bool test(ComponentId component) const {
+    return component < Bits && (bits[component / 64] >> (component % 64)) & 1;
+  }
+
+  /*! @brief Returns true if every component of the other mask is in this mask */
+  bool contains(const BasicComponentMask &other) const {
+    for (std::size_t i = 0; i < words; ++i) {
+      if ((bits[i] & other.bits[i]) != other.bits[i])
+        return false;
+    }
+    return true;
+  }
+
+  /*! @brief Returns true if both masks share a component */
+  bool intersects(const BasicComponentMask &other) const {
+    for (std::size_t i = 0; i < words; ++i) {
+      if (bits[i] & other.bits[i])
+        return true;
+    }
+    return false;
+  }
+
+  /*! @brief Returns the amount of components in the mask */
+  std::size_t count() const {
+    std::size_t amount { 0 };
+    for (uint64_t word: bits) {
+      amount += __builtin_popcountll(word);
+    }
+    return amount;
+  }
+
+  bool operator==(const BasicComponentMask &other) const = default;
+
+  /*! @brief Hashes the mask in O(words) */
+  std::size_t hash() const {
+    std::size_t seed { words };
+    for (uint64_t word: bits) {
+      word = (word ^ (word >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+      word = (word ^ (word >> 27)) * UINT64_C(0x94d049bb133111eb);
+      word = word ^ (word >> 31);
+      seed ^= word + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+
+private:
+  /*! @brief The words of the bitset */
+  std::array<uint64_t, words> bits {};
+};
+
+/*! @brief Component mask with the configured width */
+using ComponentMask = BasicComponentMask<ECS_MAX_COMPONENTS>;
+
+namespace std
+{
+/*! @brief Hashing of component masks for unordered containers */
+template<std::size_t Bits>
+struct hash<BasicComponentMask<Bits>>
+{
+    size_t operator()(BasicComponentMask<Bits> const& mask) const noexcept
+    {
+        return mask.hash();
+    }
+};
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include "Types.hpp"
 #include "TypeMapper.hpp"
 
@@ -20,23 +23,90 @@ public:
   /*! @brief Returns a new system id */
   SystemId gen_system_id() { system++; return system; }
 
-  /*! @brief Returns a new entity id */
-  EntityId gen_entity_id() { entity++; return entity; }
+  /*! @brief Returns a new entity id, reusing the slot of a deleted entity when there is one */
+  EntityId gen_entity_id() {
+    if (!free_entities.empty()) {
+      EntityId recycled { free_entities.back() };
+      free_entities.pop_back();
+      return recycled;
+    }
+    entity++;
+    return make_entity_id(static_cast<uint32_t>(entity), first_generation);
+  }
+
+  /*! @brief Releases the slot of a deleted entity, the next handle gets a new generation */
+  void recycle_entity_id(EntityId deleted) {
+    uint32_t generation { entity_generation(deleted) + 1 };
+    newest_generation = std::max(newest_generation, generation);
+    free_entities.push_back(make_entity_id(entity_slot(deleted), generation));
+  }
+
+  /*! @brief Returns the last entity slot handed out */
+  EntityId last_entity() const { return entity; }
+
+  /*! @brief Returns the handles free for reuse, the last one is handed out first */
+  const std::vector<EntityId> &get_free_entities() const { return free_entities; }
+
+  /*!
+   * @brief Restores the entity ids saved in a snapshot
+   * @param last The last entity slot handed out
+   * @param free The handles free for reuse
+   * @param newest The newest generation of the restored handles
+   */
+  void restore_entities(EntityId last, std::vector<EntityId> free, uint32_t newest) {
+    entity = last;
+    free_entities = std::move(free);
+    newest_generation = std::max(newest_generation, newest);
+    for (EntityId handle: free_entities) {
+      newest_generation = std::max(newest_generation, entity_generation(handle));
+    }
+  }
+
+  /*!
+   * @brief Forgets every entity id, the slots are handed out again from the first one with a
+   * generation newer than any handle given before, so old handles stay stale
+   */
+  void reset_entities() {
+    entity = 0;
+    free_entities.clear();
+    first_generation = newest_generation + 1;
+    newest_generation = first_generation;
+  }
+
+  /*! @brief Forgets every archetype id, the next archetype gets the first id after the root */
+  void reset_archetypes() { archetype = 0; }
 
   /*! @brief Returns a new archetype id */
   ArchetypeId gen_archetype_id() { archetype++; return archetype; }
 
-  /*! @brief Returns the id associated with the component type */
+  /*!
+   * @brief Returns the id associated with the component type (const qualifiers are ignored),
+   * 0 for types that were not registered. The lookup is a load indexed by the type id
+   */
   template <typename Component>
-  ComponentId get_component_id() { return component_index.find<Component>()->second; }
+  ComponentId get_component_id() {
+    uint64_t type { component_index.id<std::remove_const_t<Component>>() };
+    return type < component_types.size() ? component_types[type] : 0;
+  }
 
   /*! @brief Inserts a component in the type mapper */
   template <typename Component>
-  void insert_component_id() { component_index.put<Component>(gen_component_id()); }
+  void insert_component_id() {
+    ComponentId id { gen_component_id() };
+    component_index.put<Component>(id);
+    uint64_t type { component_index.id<Component>() };
+    if (type >= component_types.size()) {
+      component_types.resize(type + 1, 0);
+    }
+    component_types[type] = id;
+  }
 
   /*! @brief Returns the amount of components in the component mapper */
   std::size_t get_component_amount() { return component_index.size(); }
 
+  /*! @brief Returns the bytes reserved by the list of recycled entity ids */
+  std::size_t free_list_bytes() const { return free_entities.capacity() * sizeof(EntityId); }
+
   /*!
    * @brief Creates an archetype signature from template parameters
    * @tparam Components The components that represent the archetype
@@ -53,6 +123,12 @@ public:
 private:
   /*! @brief The current entity id in the controller */
   EntityId entity { 0 };
+  /*! @brief Handles (with bumped generation) of the slots free for reuse */
+  std::vector<EntityId> free_entities;
+  /*! @brief Generation of the slots handed out for the first time */
+  uint32_t first_generation { 0 };
+  /*! @brief Newest generation handed out, bounds the generations of every handle */
+  uint32_t newest_generation { 0 };
   /*! @brief The current component id in the controller */
   ComponentId component { 0 };
   /*! @brief The current system id in the controller */
@@ -61,4 +137,6 @@ private:
   ArchetypeId archetype { 0 };
   /*! @brief Maps a component type with its id */
   TypeMapper<ComponentId> component_index;
+  /*! @brief Component id by the type id of the type mapper, 0 for types that are not components */
+  std::vector<ComponentId> component_types;
 };
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include "AlignedSpan.hpp"
+
+/*!
+ * @brief Reference chunk kernels over float arrays (component fields or flattened components).
+ * They run with AVX2 and FMA when the CPU has them, SSE2 otherwise, and a scalar loop on other
+ * architectures. The arrays must not overlap
+ */
+
+/*! @brief Returns the instruction set the kernels run with ("avx2", "sse2" or "scalar") */
+const char *kernel_isa();
+
+/*!
+ * @brief y += a * x, e.g. position += velocity * dt
+ * @param y The updated array
+ * @param x The added array, same size as y
+ * @param a The factor of x
+ * @param amount Amount of elements
+ */
+void axpy(float *__restrict y, const float *__restrict x, float a, std::size_t amount);
+
+/*! @brief y *= a */
+void scale(float *__restrict y, float a, std::size_t amount);
+
+/*! @brief Returns the sum of x[i] * y[i] */
+float dot(const float *__restrict x, const float *__restrict y, std::size_t amount);
+
+/*! @brief Scalar y += a * x, the baseline of the benchmarks */
+void axpy_scalar(float *__restrict y, const float *__restrict x, float a, std::size_t amount);
+
+/*! @brief y += a * x over the arrays of a chunk */
+inline void axpy(AlignedSpan<float> y, AlignedSpan<const float> x, float a) {
+  axpy(y.data(), x.data(), a, y.size());
+}
+
+/*! @brief y += a * x over any span */
+inline void axpy(std::span<float> y, std::span<const float> x, float a) {
+  axpy(y.data(), x.data(), a, y.size());
+}
+
+/*! @brief y *= a over the array of a chunk */
+inline void scale(AlignedSpan<float> y, float a) {
+  scale(y.data(), a, y.size());
+}
+
+/*! @brief Returns the dot product of the arrays of a chunk */
+inline float dot(AlignedSpan<const float> x, AlignedSpan<const float> y) {
+  return dot(x.data(), y.data(), x.size());
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Types.hpp"
+
+/*! @brief Memory of the column of a component in an archetype */
+struct ColumnMemory {
+  ComponentId component;
+  /*! @brief Bytes of the allocated chunks */
+  std::size_t reserved;
+  /*! @brief Bytes of the occupied rows */
+  std::size_t used;
+};
+
+/*! @brief Memory of an archetype */
+struct ArchetypeMemory {
+  ArchetypeId id;
+  /*! @brief Amount of rows */
+  std::size_t entities;
+  /*! @brief Bytes of the allocated chunks of all the columns */
+  std::size_t reserved;
+  /*! @brief Bytes of the occupied rows of all the columns */
+  std::size_t used;
+  /*! @brief Bookkeeping of the archetype (object, signature, row to entity table, edges, chunk tables) */
+  std::size_t overhead;
+  /*! @brief The columns in signature order */
+  std::vector<ColumnMemory> columns;
+};
+
+/*! @brief Memory of a component type across all the archetypes */
+struct ComponentMemory {
+  ComponentId component;
+  /*! @brief Amount of archetypes with a column of the component */
+  std::size_t archetypes;
+  std::size_t reserved;
+  std::size_t used;
+};
+
+/*! @brief Memory of an index structure of the registry */
+struct IndexMemory {
+  std::string name;
+  std::size_t bytes;
+};
+
+/*!
+ * @brief Snapshot of the memory of a registry. Column bytes are exact, the bytes of node
+ * based containers (hash maps, trees) are estimated from their size and bucket count
+ */
+struct MemoryStats {
+  std::vector<ArchetypeMemory> archetypes;
+  std::vector<ComponentMemory> components;
+  std::vector<IndexMemory> indices;
+
+  /*! @brief Returns the bytes of the allocated chunks */
+  std::size_t reserved() const;
+
+  /*! @brief Returns the bytes of the occupied rows */
+  std::size_t used() const;
+
+  /*! @brief Returns the bytes of the bookkeeping (archetype overhead and indices) */
+  std::size_t overhead() const;
+
+  /*!
+   * @brief Writes a compact report: totals, the archetypes wasting the most bytes,
+   * the components and the indices
+   * @param out The stream the report is written to
+   * @param top Amount of archetypes listed
+   */
+  void dump(std::ostream &out, std::size_t top = 10) const;
+};
+
+/*! @brief Returns the estimated bytes of a hash map or set (nodes and buckets) */
+template <typename HashMap>
+std::size_t hash_map_bytes(const HashMap &map) {
+  return map.size() * (sizeof(typename HashMap::value_type) + 2 * sizeof(void*)) + map.bucket_count() * sizeof(void*);
+}
+
+/*! @brief Returns the estimated bytes of a tree map (nodes) */
+template <typename TreeMap>
+std::size_t tree_map_bytes(const TreeMap &map) {
+  return map.size() * (sizeof(typename TreeMap::value_type) + 4 * sizeof(void*));
+}
+
+/*! @brief Returns the bytes reserved by a vector */
+template <typename Vector>
+std::size_t vector_bytes(const Vector &vector) {
+  return vector.capacity() * sizeof(typename Vector::value_type);
+}
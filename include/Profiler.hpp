@@ -0,0 +1,114 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Types.hpp"
+
+/*! @brief One run of a system in a tick */
+struct SystemSample {
+  /*! @brief Tick the system ran in (counted by the profiler) */
+  uint64_t tick;
+  /*! @brief Start of the run in nanoseconds since the profiler was created */
+  int64_t start_ns;
+  /*! @brief Wall time of the run in nanoseconds */
+  int64_t duration_ns;
+  /*! @brief Entities the system iterated */
+  std::size_t entities;
+  /*! @brief Archetypes the system iterated */
+  std::size_t archetypes;
+  /*! @brief Thread of the pool that ran the system */
+  std::size_t thread;
+};
+
+/*! @brief Statistics of the samples kept for a system */
+struct SystemTimings {
+  std::size_t samples;
+  int64_t min_ns;
+  int64_t avg_ns;
+  int64_t p99_ns;
+  int64_t max_ns;
+};
+
+/*!
+ * @brief Keeps the last samples of every system in a fixed size ring buffer. Recording does
+ * not allocate nor lock: each system has its own ring, created when the system is registered,
+ * and a system runs at most once per tick. The registry only records when it is compiled with
+ * ECS_PROFILING
+ */
+class Profiler {
+public:
+  /*! @brief Creates a profiler keeping the last capacity samples of each system */
+  Profiler(std::size_t capacity = 256);
+
+  /*! @brief Creates the ring of a system, named "system <id>" until it gets a label */
+  void add_system(SystemId system);
+
+  /*! @brief Names a system in the statistics and the trace */
+  void set_label(SystemId system, std::string label);
+
+  /*! @brief Returns the name of a system */
+  const std::string &get_label(SystemId system) const;
+
+  /*! @brief Starts a new tick, returns its number */
+  uint64_t begin_tick();
+
+  /*! @brief Records the whole duration of the current tick (systems and command flush) */
+  void end_tick(int64_t start_ns);
+
+  /*! @brief Records a run of a system, the system must have been added */
+  void record(SystemId system, const SystemSample &sample);
+
+  /*! @brief Returns the kept samples of a system, oldest first */
+  std::vector<SystemSample> get_samples(SystemId system) const;
+
+  /*! @brief Returns min, average, p99 and max of the kept samples, nullopt without samples */
+  std::optional<SystemTimings> get_timings(SystemId system) const;
+
+  /*! @brief Returns the statistics of the whole ticks */
+  std::optional<SystemTimings> get_tick_timings() const;
+
+  /*!
+   * @brief Writes the kept samples as Chrome trace events (JSON), which can be opened in
+   * about:tracing or Perfetto. Each system run is a complete event on the thread that ran it
+   */
+  void export_chrome_trace(std::ostream &out) const;
+
+  /*! @brief Drops the samples, keeping the systems and their labels */
+  void clear();
+
+  /*! @brief Returns the nanoseconds since the profiler was created */
+  int64_t now() const;
+
+private:
+  /*! @brief Ring buffer of the samples of a system */
+  struct Ring {
+    std::string label;
+    std::vector<SystemSample> samples;
+    std::size_t next { 0 };
+    std::size_t count { 0 };
+  };
+
+  /*! @brief Appends a sample to a ring, overwriting the oldest one when full */
+  void push(Ring &ring, const SystemSample &sample);
+
+  /*! @brief Returns the samples of a ring, oldest first */
+  std::vector<SystemSample> ordered(const Ring &ring) const;
+
+  /*! @brief Computes the statistics of a ring */
+  std::optional<SystemTimings> timings(const Ring &ring) const;
+
+  /*! @brief Amount of samples kept per system */
+  std::size_t capacity;
+  /*! @brief Current tick */
+  uint64_t tick { 0 };
+  /*! @brief Start of the time of the samples */
+  std::chrono::steady_clock::time_point epoch;
+  /*! @brief Rings of the systems */
+  std::map<SystemId, Ring> rings;
+  /*! @brief Ring of the whole ticks */
+  Ring ticks;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*! @brief Version of the snapshot format, bumped on incompatible changes */
+constexpr uint32_t snapshot_version { 1 };
+
+/*! @brief Written in the header, a snapshot is only loaded on machines with the same byte order */
+constexpr uint32_t snapshot_byte_order { 0x01020304 };
+
+/*! @brief Alignment of the column images in the file (the cache line, as the chunks) */
+constexpr std::size_t snapshot_alignment { 64 };
+
+/*!
+ * @brief Start of a snapshot file. The header is followed by the component table, the free
+ * entity handles and the archetypes
+ */
+struct SnapshotHeader {
+  /*! @brief "ECSSNAP" */
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  /*! @brief Rows per chunk of the saving build, the column images are whole chunks */
+  uint64_t chunk_rows;
+  /*! @brief Amount of entries in the component table */
+  uint64_t components;
+  /*! @brief Amount of archetypes */
+  uint64_t archetypes;
+  /*! @brief Last entity slot handed out */
+  uint64_t last_entity;
+  /*! @brief Amount of entity handles free for reuse */
+  uint64_t free_entities;
+};
+
+/*! @brief Entry of the component table, archetypes refer to components by their position */
+struct SnapshotComponent {
+  /*! @brief Hash of the type name, matched against the components of the loading registry */
+  uint64_t name_hash;
+  uint64_t size;
+  uint64_t alignment;
+  /*! @brief Size of a chunk image of the component */
+  uint64_t chunk_bytes;
+};
+
+/*!
+ * @brief Header of an archetype, followed by the positions of its components in the component
+ * table, the entity of each row and, from the next multiple of snapshot_alignment, the chunk
+ * images of each column in signature order
+ */
+struct SnapshotArchetype {
+  /*! @brief Amount of components */
+  uint64_t components;
+  /*! @brief Amount of rows */
+  uint64_t rows;
+};
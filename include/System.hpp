@@ -1,21 +1,25 @@
 #pragma once
 #include <cstdint>
 #include <iostream>
-#include <functional>
-#include <variant>
+#include <array>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include "AlignedSpan.hpp"
 #include "Archetype.hpp"
+#include "CommandBuffer.hpp"
 #include "IdController.hpp"
+#include "ThreadPool.hpp"
 #include "Types.hpp"
 
 /*! @brief System base class, represents a pointer to an instance of a system */
 class SystemBase {
 public:
   /*! @brief Default constructor */
-  SystemBase(SystemId system_id, uint64_t tick,
-             std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>>
-                 &component_archetype_mapping, IdController &id_controller, std::vector<ComponentId> signature)
-      : id{system_id}, every_x_tick{tick},
-        component_archetype_mapping{component_archetype_mapping}, ids{id_controller}, signature{signature} {};
+  SystemBase(SystemId system_id, uint64_t tick, std::vector<ComponentId> signature,
+             std::vector<ComponentId> writes)
+      : id{system_id}, every_x_tick{tick}, signature{signature}, writes{writes}, mask{signature} {};
 
   /*! @brief Runs the system */
   virtual void run() = 0;
@@ -26,21 +30,86 @@ public:
   /*! @brief Return the tick rate of the system */
   uint64_t get_tick() { return every_x_tick; }
 
-  /*! @brief Adds archetype to the system */
+  /*! @brief Sets the tick (modulo the tick rate) the system runs in */
+  void set_phase(uint64_t tick_phase) { phase = tick_phase; }
+
+  /*! @brief Names the system (used by the profiler) */
+  void set_label(std::string system_label) { label = std::move(system_label); }
+
+  /*! @brief Returns the name of the system, empty if it was not named */
+  const std::string &get_label() const { return label; }
+
+  /*! @brief Returns the amount of entities the system iterates */
+  std::size_t entity_count() const {
+    std::size_t amount { 0 };
+    for (const archetype_t &archetype: archetype_list) {
+      amount += archetype->size();
+    }
+    return amount;
+  }
+
+  /*! @brief Returns the amount of archetypes the system iterates */
+  std::size_t archetype_count() const { return archetype_list.size(); }
+
+  /*! @brief Returns true if the system should run in a cycle */
+  bool runs_in(uint64_t cycle) { return cycle % every_x_tick == phase; }
+
+  /*!
+   * @brief Returns true if both systems can not run at the same time, that is when one
+   * of them writes a component the other one reads or writes
+   */
+  bool conflicts_with(const SystemBase &other) const {
+    auto writes_any = [] (const std::vector<ComponentId> &written, const std::vector<ComponentId> &accessed) {
+      return std::find_first_of(written.begin(), written.end(), accessed.begin(), accessed.end()) != written.end();
+    };
+    return writes_any(writes, other.signature) || writes_any(other.writes, signature);
+  }
+
+  /*!
+   * @brief Makes the system split its rows across a thread pool, each task runs one chunk.
+   * The chunks are cache aligned, so the tasks never write the same cache line
+   * @param thread_pool The pool, nullptr runs the system in the calling thread
+   */
+  void set_thread_pool(ThreadPool *thread_pool) { pool = thread_pool; }
+
+  /*! @brief Records a system that conflicts with this one */
+  void add_conflict(SystemId system) { conflicts.push_back(system); }
+
+  /*! @brief Returns the systems that conflict with this one */
+  const std::vector<SystemId> &get_conflicts() const { return conflicts; }
+
+  /*!
+   * @brief Adds archetype to the system if it matches, resolving the column of each component once.
+   * Called once for every archetype created after the system, keeping the cache up to date
+   */
   void add_archetype(archetype_t archetype) {
-    auto signature_arch = archetype->get_type();
-    std::sort(signature_arch.begin(), signature_arch.end());
-    std::sort(signature.begin(), signature.end());
-    if (std::includes(signature_arch.begin(), signature_arch.end(), signature.begin(), signature.end())) {
-      archetype_list.insert(archetype); 
+    if (!archetype->get_mask().contains(mask)) {
+      return;
+    }
+    if (std::find(archetype_list.begin(), archetype_list.end(), archetype) != archetype_list.end()) {
+      return;
+    }
+    archetype_list.push_back(archetype);
+    for (ComponentId component: signature) {
+      column_list.push_back(archetype->column_value(component));
     }
   }
 
-  /* @brief Removes archetype from the system */
+  /* @brief Removes archetype from the system (when the archetype is destroyed) */
   void remove_archetype(archetype_t archetype) {
     auto find_it = std::find(archetype_list.begin(), archetype_list.end(), archetype);
-    if (find_it != archetype_list.end())
-      archetype_list.erase(find_it);
+    if (find_it == archetype_list.end())
+      return;
+    auto index = std::distance(archetype_list.begin(), find_it);
+    archetype_list.erase(find_it);
+    auto columns_it = column_list.begin() + index * signature.size();
+    column_list.erase(columns_it, columns_it + signature.size());
+  }
+
+  /* @brief Forgets every archetype (when the registry is reset) */
+  void clear_archetypes() {
+    archetype_list.clear();
+    column_list.clear();
   }
 
   /*! @brief Deletes copy constructor to avoid misuse */
@@ -63,66 +132,99 @@ protected:
   SystemId id;
   /*! @brief Represent how many ticks of interval for running this system again */
   uint64_t every_x_tick;
+  /*! @brief Offset in the interval, spreads the systems with the same tick rate */
+  uint64_t phase { 0 };
   /* @brief List of observed archetypes by the system */
-  std::unordered_set<archetype_t> archetype_list {};
-  /* @brief Reference to the mapping used to find the component columns in archetypes */
-  std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>> &component_archetype_mapping;
-  /* @brief The id controller (used for getting the component ids) */
-  IdController &ids;
+  std::vector<archetype_t> archetype_list {};
+  /* @brief Column of each component (in signature order) for each observed archetype */
+  std::vector<std::size_t> column_list {};
   /* @brief Internal system signature */
   std::vector<ComponentId> signature;
+  /* @brief Components the system writes (declared without const) */
+  std::vector<ComponentId> writes;
+  /* @brief Systems that access some component this system writes, or the other way around */
+  std::vector<SystemId> conflicts;
+  /* @brief Pool used for running the chunks in parallel, nullptr when the system is serial */
+  ThreadPool *pool { nullptr };
+  /* @brief Bitmask of the signature used for matching archetypes */
+  ComponentMask mask;
+  /* @brief Name of the system */
+  std::string label;
 };
 
-/*! @brief Abstract class that represents a system, should be extended to represent an atomic operation */
-template <typename ...Components>
+/*!
+ * @brief A system that stores its function by its concrete type, so it can be inlined.
+ * The function may receive pointers or references to the components of an entity, or
+ * std::span of each component for a whole chunk (chunk kernel). The chunk kernel may also take
+ * AlignedSpan, whose arrays are cache aligned and do not alias. Split components are only
+ * reached with the chunk kernel, as FieldSpans. Components declared as const are only read,
+ * which lets the scheduler run the system alongside other readers
+ */
+template <typename Func, typename ...Components>
 class System : public SystemBase {
 public:
   /*! @brief Default constructor */
-  System(SystemId system_id, std::function<void(Components*...)> function,
-         uint64_t tick,
-         std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>>
-             &component_archetype_mapping,
-         IdController &id_controller, std::vector<ComponentId> signature)
-      : SystemBase{system_id, tick, component_archetype_mapping, id_controller, signature},
-        system_fn{function} {};
+  System(SystemId system_id, Func function, uint64_t tick, std::vector<ComponentId> signature,
+         std::vector<ComponentId> writes)
+      : SystemBase{system_id, tick, signature, writes}, system_fn{std::move(function)} {};
 
   /*! @brief Default destructor */
   ~System() {};
 
-  /*! @brief Runs an instance of system */
+  /*! @brief Runs an instance of system, iterating the archetypes chunk by chunk */
   void run() {
-    for (archetype_t archetype: archetype_list) {
-      std::array<std::pair<void*, std::size_t>, sizeof...(Components)> dependency_list;
-      int i = 0;
-      ([&] {
-              std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[ids.get_component_id<Components>()] };
-              ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-              if (archetype_map->count(archetype->get_id()) == 0) {
-                return;
-              }
-              try {
-                dependency_list[i] = (*archetype)[a_record].get_vector<Components>();
-              } catch (std::exception e) {
-                return;
-              }
-              ++i;
-              } (), ...);
-      std::size_t iter = dependency_list[0].second;
-      std::tuple<Components*...> input;
-      for (int i = 0; i < iter; ++i) {
-        auto temp_fn = system_fn;
-        int j = 0;
-        ([&] {
-          auto part_input =  &(((Components*) dependency_list[j].first)[i]);
-          std::get<Components*>(input) = part_input;
-          ++j;
-        } (), ...);
-        std::apply(system_fn, input);
+    constexpr std::size_t amount { sizeof...(Components) };
+    ThreadPool::TaskGroup group;
+    for (std::size_t a = 0; a < archetype_list.size(); ++a) {
+      Archetype &archetype { *archetype_list[a] };
+      std::array<Column*, amount> columns;
+      for (std::size_t j = 0; j < amount; ++j) {
+        columns[j] = &archetype[column_list[a * amount + j]];
+      }
+      std::size_t chunks { archetype.chunk_count() };
+      for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        std::size_t rows { archetype.chunk_size(chunk) };
+        CommandOrigin origin { id, archetype.get_id(), chunk };
+        if (pool == nullptr) {
+          CommandScope scope { origin };
+          run_chunk(columns, chunk, rows, std::index_sequence_for<Components...>{});
+        } else {
+          pool->run(group, [this, columns, chunk, rows, origin] {
+            CommandScope scope { origin };
+            run_chunk(columns, chunk, rows, std::index_sequence_for<Components...>{});
+          });
+        }
       }
     }
+    if (pool != nullptr) {
+      pool->wait(group);
+    }
   }
 
 private:
+  /*! @brief Calls the function for a chunk, with the form the function accepts */
+  template <std::size_t ...I>
+  void run_chunk(const std::array<Column*, sizeof...(Components)> &columns, std::size_t chunk,
+                 std::size_t rows, std::index_sequence<I...>) {
+    if constexpr (std::is_invocable_v<Func&, chunk_span_t<Components>...>) {
+      system_fn(make_chunk_span<Components>(*columns[I], chunk)...);
+    } else if constexpr (std::is_invocable_v<Func&, AlignedSpan<Components>...>) {
+      system_fn(AlignedSpan<Components>(static_cast<Components*>(columns[I]->template get_vector<Components>(chunk).first), rows)...);
+    } else {
+      static_assert(!(is_split_component_v<Components> || ...), "Split components are only accessed with the chunk form");
+      std::tuple<Components*...> arrays { static_cast<Components*>(columns[I]->template get_vector<Components>(chunk).first)... };
+      if constexpr (std::is_invocable_v<Func&, Components*...>) {
+        for (std::size_t i = 0; i < rows; ++i) {
+          system_fn((std::get<I>(arrays) + i)...);
+        }
+      } else {
+        for (std::size_t i = 0; i < rows; ++i) {
+          system_fn(std::get<I>(arrays)[i]...);
+        }
+      }
+    }
+  }
+
   /*! @brief Function that represents the system inner working */
-  std::function<void(Components*...)> system_fn;
+  Func system_fn;
 };
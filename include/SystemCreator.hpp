@@ -1,35 +1,56 @@
 #pragma once
+#include <map>
 #include <memory>
+#include <type_traits>
 #include "System.hpp"
 #include "Types.hpp"
 
 class SystemCreator {
 public:
   /*! @brief Default constructor */
-  SystemCreator(std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>>
-                    &component_archetype_mapping,
+  SystemCreator(std::pmr::unordered_map<ComponentId, ArchetypeMap> &component_archetype_mapping,
                 IdController &id_controller,
-                std::unordered_map<ArchetypeId, archetype_t> &archetype_index)
+                std::pmr::vector<archetype_t> &archetype_table,
+                std::map<SystemId, SystemBase*> &system_index)
       : component_archetype_mapping{component_archetype_mapping},
-        archetype_index{archetype_index},
+        archetype_table{archetype_table},
+        system_index{system_index},
         ids{id_controller} {};
 
-  /*! @brief Auxiliary function for creating a new system */
+  /*!
+   * @brief Auxiliary function for creating a new system, also links it in the conflict
+   * graph with the registered systems that access the same components
+   */
   template <typename ...Components, typename Func>
   SystemBase *create_system(SystemId system_id, Func function, uint64_t tick_rate=1) {
     std::vector<ComponentId> signature = ids.make_archetype_signature<Components...>();
-    auto system = new System<Components...>(system_id, function, tick_rate, component_archetype_mapping, ids, signature);
+    std::vector<ComponentId> writes;
+    ([&] {
+      if constexpr (!std::is_const_v<Components>) {
+        writes.push_back(ids.get_component_id<Components>());
+      }
+    } (), ...);
+    auto system = new System<Func, Components...>(system_id, std::move(function), tick_rate, signature, writes);
+    for (auto [registered_id, registered]: system_index) {
+      if (system->conflicts_with(*registered)) {
+        system->add_conflict(registered_id);
+        registered->add_conflict(system_id);
+      }
+    }
+    ArchetypeMap *smallest { nullptr };
     for (ComponentId component: signature) {
-      auto archetype_map = component_archetype_mapping[component];
-      if (archetype_map == nullptr)
-        continue;
-      for (auto it: *archetype_map) {
-        ArchetypeId archetype_id = it.first;
-        archetype_t archetype = archetype_index[archetype_id];
-        if (archetype == nullptr)
-          continue;
-        system->add_archetype(archetype);
+      auto archetype_map = component_archetype_mapping.find(component);
+      if (archetype_map == component_archetype_mapping.end()) {
+        return system;
       }
+      if (smallest == nullptr || archetype_map->second.size() < smallest->size())
+        smallest = &archetype_map->second;
+    }
+    if (smallest == nullptr)
+      return system;
+    for (auto [archetype_id, _]: *smallest) {
+      if (archetype_id < archetype_table.size() && archetype_table[archetype_id] != nullptr)
+        system->add_archetype(archetype_table[archetype_id]);
     }
     return system;
   }
@@ -38,9 +59,11 @@ public:
   ~SystemCreator() {};
 private:
   /*! @brief Relation for the component and related archetypes */
-  std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>> &component_archetype_mapping;
-  /*! @brief Relationship between a list of components and the archetypes */
-  std::unordered_map<ArchetypeId, archetype_t> &archetype_index;
+  std::pmr::unordered_map<ComponentId, ArchetypeMap> &component_archetype_mapping;
+  /*! @brief The archetypes of the registry by id */
+  std::pmr::vector<archetype_t> &archetype_table;
+  /*! @brief The registered systems */
+  std::map<SystemId, SystemBase*> &system_index;
   /*! @brief Class responsible for creating the ids and managing their relations */
   IdController &ids;
 };
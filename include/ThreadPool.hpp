@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * @brief Work stealing thread pool, each worker has its own queue and steals from the
+ * others when it runs out of tasks. The thread that waits for a group helps running tasks,
+ * so a pool with n threads spawns n - 1 workers
+ */
+class ThreadPool {
+public:
+  /*! @brief Alias for a task of the pool */
+  using Task = std::function<void()>;
+
+  /*! @brief Counter of the pending tasks of a batch, used for waiting on it */
+  struct TaskGroup {
+    std::atomic<std::size_t> pending { 0 };
+  };
+
+  /*!
+   * @brief Starts the workers
+   * @param threads Amount of threads running tasks, including the waiting thread
+   */
+  ThreadPool(std::size_t threads);
+
+  /*! @brief Stops and joins the workers */
+  ~ThreadPool();
+
+  /*! @brief Deletes copy constructor to avoid misuse */
+  ThreadPool(const ThreadPool &) = delete;
+
+  /*! @brief Deletes copy assignment to avoid misuse */
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /*!
+   * @brief Schedules a task, it runs inline when there are no workers
+   * @param group The group the task is accounted in
+   * @param task The task to be run
+   */
+  void run(TaskGroup &group, Task task);
+
+  /*! @brief Waits for all the tasks of a group, running queued tasks meanwhile */
+  void wait(TaskGroup &group);
+
+  /*! @brief Returns the amount of threads that run tasks (workers and the waiting thread) */
+  std::size_t size() const { return workers.size() + 1; }
+
+  /*! @brief Returns the index of the current thread in the pool, 0 for threads outside of it */
+  static std::size_t current_thread();
+
+private:
+  /*! @brief Queue of a worker */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /*! @brief Main loop of a worker */
+  void work(std::size_t index);
+
+  /*! @brief Pops a task from the queue of the thread or steals one from another queue */
+  bool try_run_one(std::size_t index);
+
+  /*! @brief One queue per thread, index 0 receives the tasks of external threads */
+  std::vector<std::unique_ptr<Queue>> queues;
+  /*! @brief The worker threads */
+  std::vector<std::thread> workers;
+  /*! @brief Amount of queued tasks (not running) */
+  std::atomic<std::size_t> queued { 0 };
+  /*! @brief Set when the pool is being destroyed */
+  bool stopping { false };
+  /*! @brief Protects the sleeping of the workers */
+  std::mutex sleep_mutex;
+  /*! @brief Wakes the workers when there are new tasks */
+  std::condition_variable wake;
+};
@@ -1,4 +1,7 @@
+#pragma once
 #include <atomic>
+#include <cstdint>
+#include <string_view>
 
 extern std::atomic_uint64_t TypeIdCounter;
 
@@ -11,3 +14,26 @@ int getTypeId() {
   static uint64_t id = ++TypeIdCounter;
   return id;
 }
+
+/*!
+ * @brief Returns the name of a type as spelled by the compiler, unlike the ids above it is the
+ * same in every run of the program
+ */
+template <typename T>
+constexpr std::string_view type_name() {
+  std::string_view function { __PRETTY_FUNCTION__ };
+  std::size_t first { function.find("T = ") + 4 };
+  std::size_t last { function.find_first_of(";]", first) };
+  return function.substr(first, last - first);
+}
+
+/*! @brief Returns the FNV-1a hash of the name of a type, a stable id for persisted data */
+template <typename T>
+constexpr uint64_t type_name_hash() {
+  uint64_t hash { UINT64_C(14695981039346656037) };
+  for (char c: type_name<T>()) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= UINT64_C(1099511628211);
+  }
+  return hash;
+}
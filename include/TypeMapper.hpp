@@ -57,6 +57,19 @@ public:
     return value;
   }
 
+  /*! @brief Removes every mapping to a value, returns the amount of removed mappings */
+  std::size_t remove_value(const Type &value) {
+    std::size_t removed = std::erase_if(mapper, [&] (const value_type &entry) { return entry.second == value; });
+    _size -= removed;
+    return removed;
+  }
+
+  /*! @brief Removes every mapping */
+  void clear() {
+    mapper.clear();
+    _size = 0;
+  }
+
   /*! @brief Inserts in the type mapping, copy (for pointers) */
   template <typename ...Key>
   uint64_t put(Type value) {
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <memory_resource>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -10,9 +11,23 @@ using ComponentId = uint64_t;
 /*! @brief Archetype id internal representation */
 using ArchetypeId = uint64_t;
 
-/*! @brief Entity id internal representation */
+/*!
+ * @brief Entity id internal representation, the lower 32 bits are the slot in the
+ * entity index and the upper 32 bits are the generation of that slot
+ */
 using EntityId = uint64_t;
 
+/*! @brief Returns the slot of an entity in the entity index */
+constexpr uint32_t entity_slot(EntityId entity) { return static_cast<uint32_t>(entity); }
+
+/*! @brief Returns the generation of an entity handle */
+constexpr uint32_t entity_generation(EntityId entity) { return static_cast<uint32_t>(entity >> 32); }
+
+/*! @brief Packs a slot and a generation into an entity handle */
+constexpr EntityId make_entity_id(uint32_t slot, uint32_t generation) {
+  return (static_cast<EntityId>(generation) << 32) | slot;
+}
+
 /*! @brief System id representation */
 using SystemId = uint64_t;
 
@@ -26,7 +41,7 @@ using ArchetypeSet = std::unordered_set<ArchetypeId>;
 using ArchetypeRecord = std::size_t;
 
 /*! @brief Finding components in archetypes in O(1) */
-using ArchetypeMap = std::unordered_map<ArchetypeId, ArchetypeRecord>;
+using ArchetypeMap = std::pmr::unordered_map<ArchetypeId, ArchetypeRecord>;
 
 /*! @brief The amount of dependent types a node current relates to */
 using dependencies_t = std::size_t;
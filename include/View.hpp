@@ -0,0 +1,132 @@
+#pragma once
+#include <array>
+#include <span>
+#include <tuple>
+#include <vector>
+#include "Archetype.hpp"
+#include "CommandBuffer.hpp"
+#include "Column.hpp"
+#include "ThreadPool.hpp"
+
+/*!
+ * @brief Typed iteration over every archetype that has all the components, yields
+ * one std::span per component for each chunk of an archetype (FieldSpans for split components,
+ * whose elements are proxies with per field access). The columns are resolved
+ * when the view is created, so a view should not outlive structural changes in the registry
+ */
+template <typename ...Components>
+class View {
+public:
+  /*! @brief A matching archetype with the column of each component */
+  struct Entry {
+    archetype_t archetype;
+    std::array<Column*, sizeof...(Components)> columns;
+  };
+
+  /*! @brief The spans of a chunk, in the order of the template parameters */
+  using value_type = std::tuple<chunk_span_t<Components>...>;
+
+  /*! @brief Iterator over the chunks of all the matching archetypes */
+  class iterator {
+  public:
+    iterator(const std::vector<Entry> *entries, std::size_t entry, std::size_t chunk)
+        : entries{entries}, entry{entry}, chunk{chunk} { skip_empty(); };
+
+    /*! @brief Returns the spans of the current chunk */
+    value_type operator*() const {
+      const Entry &current { (*entries)[entry] };
+      return make_spans(current, std::index_sequence_for<Components...>{});
+    }
+
+    /*! @brief Advances to the next chunk */
+    iterator &operator++() {
+      ++chunk;
+      skip_empty();
+      return *this;
+    }
+
+    bool operator==(const iterator &other) const {
+      return entry == other.entry && chunk == other.chunk;
+    }
+
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+
+    /*! @brief Returns the archetype of the current chunk */
+    archetype_t get_archetype() const { return (*entries)[entry].archetype; }
+
+    /*! @brief Returns the index of the current chunk in its archetype */
+    std::size_t get_chunk() const { return chunk; }
+
+  private:
+    /*! @brief Moves to the next archetype when the chunks of the current one are over */
+    void skip_empty() {
+      while (entry < entries->size() && chunk >= (*entries)[entry].archetype->chunk_count()) {
+        ++entry;
+        chunk = 0;
+      }
+    }
+
+    template <std::size_t ...I>
+    value_type make_spans(const Entry &current, std::index_sequence<I...>) const {
+      return value_type { make_chunk_span<Components>(*current.columns[I], chunk)... };
+    }
+
+    /*! @brief The entries of the view */
+    const std::vector<Entry> *entries;
+    /*! @brief Current archetype */
+    std::size_t entry;
+    /*! @brief Current chunk of the archetype */
+    std::size_t chunk;
+  };
+
+  /*! @brief Creates a view from the resolved archetypes */
+  View(std::vector<Entry> entries) : entries{std::move(entries)} {};
+
+  iterator begin() const { return iterator(&entries, 0, 0); }
+
+  iterator end() const { return iterator(&entries, entries.size(), 0); }
+
+  /*! @brief Calls a function with a reference to the components of every entity */
+  template <typename Func>
+  void each(Func fn) const {
+    for (auto spans: *this) {
+      std::size_t rows { std::get<0>(spans).size() };
+      for (std::size_t i = 0; i < rows; ++i) {
+        std::apply([&] (auto &...span) { fn(span[i]...); }, spans);
+      }
+    }
+  }
+
+  /*!
+   * @brief Calls a function for every entity, spreading the chunks across a thread pool.
+   * The function runs concurrently, so it must only touch the components it receives. The
+   * commands recorded by each chunk are tagged with its archetype and chunk index (and the
+   * system of the caller), so they are flushed in the same order whatever thread ran the chunk
+   */
+  template <typename Func>
+  void par_each(ThreadPool &pool, Func fn) const {
+    ThreadPool::TaskGroup group;
+    SystemId caller { CommandBuffer::current_origin().system };
+    for (iterator chunk = begin(); chunk != end(); ++chunk) {
+      CommandOrigin origin { caller, chunk.get_archetype()->get_id(), chunk.get_chunk() };
+      pool.run(group, [&fn, spans = *chunk, origin] {
+        CommandScope scope { origin };
+        std::size_t rows { std::get<0>(spans).size() };
+        for (std::size_t i = 0; i < rows; ++i) {
+          std::apply([&] (auto &...span) { fn(span[i]...); }, spans);
+        }
+      });
+    }
+    pool.wait(group);
+  }
+
+  /*! @brief Returns the amount of matched archetypes */
+  std::size_t archetype_count() const { return entries.size(); }
+
+  /*! @brief Returns the resolved archetypes */
+  const std::vector<Entry> &get_entries() const { return entries; }
+
+private:
+  /*! @brief The matched archetypes */
+  std::vector<Entry> entries;
+};
@@ -1,23 +1,42 @@
 #pragma once
 #include <optional>
+#include <span>
+#include <array>
+#include <memory_resource>
+#include <numeric>
+#include <string>
 #include <unordered_map>
+#include "ChunkPool.hpp"
 #include "IdController.hpp"
+#include "MemoryStats.hpp"
+#include "Profiler.hpp"
 #include "Archetype.hpp"
+#include "CommandBuffer.hpp"
 #include "Hasher.hpp"
 #include "System.hpp"
 #include "SystemCreator.hpp"
+#include "ThreadPool.hpp"
 #include "TypeMapper.hpp"
 #include "Types.hpp"
+#include "View.hpp"
 
 
 /*! @brief The registry for a world of entities, a program may have more than one */
 class WorldRegistry {
 public:
-  /*! @brief Contructor to the world registry, will create its own archetype graph */
-  WorldRegistry(uint64_t cycle_reset = 10);
+  /*!
+   * @brief Contructor to the world registry, will create its own archetype graph
+   * @param cycle_reset The amount of ticks in a cycle, raised to a multiple of the tick rates
+   * @param threads Amount of threads used for running systems (1 runs them serially)
+   * @param upstream Resource the arenas of the registry take their memory from: a monotonic
+   * arena for the archetype graph, a pool of fixed size blocks for the column chunks and a pool
+   * for the nodes and buffers of the indices
+   */
+  WorldRegistry(uint64_t cycle_reset = 10, std::size_t threads = std::thread::hardware_concurrency(),
+                std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
   
-  /*! @brief Destructor for the WorldRegistry */
-  ~WorldRegistry() = default;
+  /*! @brief Destructor for the WorldRegistry, destroys the archetypes before the arenas */
+  ~WorldRegistry();
 
   /*! @brief Registers a new component in the registry */
   template <typename Component>
@@ -27,10 +46,20 @@ public:
    * @brief Registers a system in the registry
    * @param system Lambda function that represents a system
    * @param tick_rate Every something ticks a system will run
-   * when the registry itself ticks
+   * when the registry itself ticks, systems with the same rate are spread
+   * across the ticks of the interval
+   */
+  template <typename ...T, typename Func>
+  const SystemId register_system(Func system, uint64_t tick_rate = 1);
+
+  /*!
+   * @brief Registers a system whose rows are split in chunks across the thread pool,
+   * the function is called concurrently so it must only touch the components it receives
+   * @param system Lambda function that represents a system
+   * @param tick_rate Every something ticks a system will run
    */
   template <typename ...T, typename Func>
-  const SystemId register_system(Func system);
+  const SystemId register_parallel_system(Func system, uint64_t tick_rate = 1);
 
   /*!
    * @brief Disables a system tempararily
@@ -38,6 +67,30 @@ public:
    */
   void disable_system(const SystemId system);
 
+  /*!
+   * @brief Reports the reserved and used bytes of every archetype, column and component,
+   * and the bytes of the index structures of the registry
+   */
+  MemoryStats memory_stats();
+
+  /*!
+   * @brief Names a system, the name is used by the profiler instead of the system id
+   * @param system The system id
+   * @param label The name of the system
+   */
+  void set_system_label(const SystemId system, std::string label);
+
+#ifdef ECS_PROFILING
+  /*! @brief Returns the timings of the systems in the last ticks */
+  Profiler &get_profiler() { return profiler; }
+#endif
+
+  /*!
+   * @brief Enables a system disabled before
+   * @param system The id of the system to be enabled
+   */
+  void enable_system(const SystemId system);
+
   /*!
    * @brief Return the component from the Registry
    * @param entity The of the entity to be searched
@@ -46,10 +99,26 @@ public:
   template <typename T>
   std::optional<T> get_component(EntityId entity);
 
+  /*!
+   * @brief Returns a pointer to the component of an entity, which can be written through
+   * @return nullptr if the entity is stale or does not have the component. The pointer is
+   * invalidated by the next structural change of the archetype
+   */
+  template <typename T>
+  T *try_get(EntityId entity);
+
+  /*!
+   * @brief Returns pointers to several components of an entity, resolving its record once
+   * @return One pointer per component, nullptr for the missing ones (all of them for stale entities)
+   */
+  template <typename ...Components>
+  std::tuple<Components*...> get(EntityId entity);
+
   /*!
    * @brief Return the component from the Registry
    * @param entity The of the entity to be searched
    * @param component The id of the component to be searched
+   * @return Pointer to the component, nullptr if missing or stored field by field (split)
    */
   void *get_component(EntityId entity, ComponentId component);
 
@@ -61,15 +130,40 @@ public:
   EntityId create_entity();
 
   /*!
-   * @brief Adds a new Archetype
+   * @brief Creates a batch of entities in the same archetype, with zeroed components
+   * @param amount The amount of entities to be created
+   * @tparam Components The archetype of the new entities
+   */
+  template<typename ...Components>
+  std::vector<EntityId> create_entities(std::size_t amount);
+
+  /*!
+   * @brief Creates a batch of entities and copies their initial components column by column
+   * @param components One span per component, all with the same size (the amount of entities)
+   */
+  template<typename ...Components>
+  std::vector<EntityId> create_entities(std::span<const Components> ...components);
+
+  /*!
+   * @brief Creates a batch of entities with the components returned by a generator
+   * @param amount The amount of entities to be created
+   * @param generator Called with the index of each entity, returns std::tuple<Components...>
+   */
+  template<typename ...Components, typename Generator>
+  std::vector<EntityId> create_entities(std::size_t amount, Generator generator);
+
+  /*!
+   * @brief Adds a new Archetype, the order of the components does not matter
+   * (returns the archetype with the same component set when there is one)
    * @param T passes the components of the new archetype
    */
   template<typename ...T>
   std::optional<ArchetypeId> register_archetype();
 
   /*!
-   * @brief Adds a new Archetype
-   * @param T passes the components of the new archetype
+   * @brief Adds a new Archetype, the signature is canonicalized (sorted, without repeated
+   * components) and the archetype with the same component set is returned when there is one
+   * @param components The components of the new archetype
    */
   archetype_t register_archetype(std::vector<ComponentId> &components);
 
@@ -113,6 +207,78 @@ public:
   template<typename T>
   archetype_t remove_component(EntityId entity);
 
+  /*!
+   * @brief Returns a view over every archetype that has all the components, iterating
+   * it yields a std::span per component for each chunk
+   * @tparam Components The components of the view (const for read only spans)
+   */
+  template<typename ...Components>
+  View<Components...> view();
+
+  /*!
+   * @brief Destroys every entity and archetype, keeping the components and the systems.
+   * Only the archetypes with non trivial components are visited to run their destructors,
+   * the chunks, columns and archetypes are given back by releasing the arenas at once, so
+   * the cost does not depend on the amount of entities or chunks of trivial components
+   * (the indices are still cleared node by node). Entity handles, views and archetypes
+   * taken before are invalidated (new entities get a newer generation, so the old handles never
+   * refer to them), and the recorded commands are dropped
+   */
+  void reset();
+
+  /*!
+   * @brief Writes the entities and their components to a binary snapshot: the component table
+   * (identified by the hash of the type names), the free entity handles and, for each archetype,
+   * its signature, the entity of each row and the raw chunks of its columns. Only trivially
+   * copyable components can be saved, systems and recorded commands are not part of it
+   * @param path The file to be written
+   */
+  void save_snapshot(const std::string &path);
+
+  /*!
+   * @brief Replaces the entities and components with the ones of a snapshot. The components
+   * must be registered (in any order). The file is memory mapped and each column is copied
+   * chunk by chunk, the entity handles keep their values. Throws when a component is not
+   * registered or the file is malformed, the whole file is checked before the world is replaced
+   * so the registry is then left untouched
+   * @param path The file to be read
+   */
+  void load_snapshot(const std::string &path);
+
+  /*!
+   * @brief Destroys the archetypes without entities, removing them from the indices and
+   * from the archetype caches of the systems
+   * @return The amount of destroyed archetypes
+   */
+  std::size_t prune_empty_archetypes();
+
+  /*!
+   * @brief Moves a contiguous run of rows to another archetype, with one copy per chunk piece
+   * of each shared column. The last rows of the source are moved into the hole
+   * @param from The source archetype
+   * @param row The first row of the run
+   * @param amount The amount of rows
+   * @param to The destination archetype
+   */
+  void migrate_rows(archetype_t from, std::size_t row, std::size_t amount, archetype_t to);
+
+  /*!
+   * @brief Adds a component to every entity matched by a view
+   * @param query The view selecting the entities
+   * @param value The initial value of the component
+   * @return The amount of entities that got the component
+   */
+  template<typename T, typename ...Filter>
+  std::size_t add_component(const View<Filter...> &query, T value = T {});
+
+  /*!
+   * @brief Removes a component from every entity matched by a view
+   * @param query The view selecting the entities
+   * @return The amount of entities that lost the component
+   */
+  template<typename T, typename ...Filter>
+  std::size_t remove_component(const View<Filter...> &query);
+
   /*! @brief Get archetype dependency graph */
   void get_dependency_graph(std::vector<ComponentId> &input) {
     std::vector<Archetype*> visited;
@@ -122,9 +288,31 @@ public:
   /*! @brief Recursive function for showing each of the graph dependencies */
   void list_each(archetype_t archetype, std::vector<ComponentId> &input, std::vector<Archetype*> &visited);
 
-  /*! @brief Ticks the entire registry */
+  /*!
+   * @brief Ticks the entire registry, systems that do not conflict run at the same time.
+   * Conflicting systems always run in registration order, so the result is deterministic.
+   * The command buffers are flushed after the systems
+   */
   void tick();
 
+  /*!
+   * @brief Returns the command buffer of the calling thread, used for recording structural
+   * changes while systems iterate. Threads outside of the registry pool share the first buffer
+   */
+  CommandBuffer &commands() {
+    std::size_t thread { ThreadPool::current_thread() };
+    return *command_buffers[thread < command_buffers.size() ? thread : 0];
+  }
+
+  /*!
+   * @brief Applies the recorded commands of every buffer. The entities are grouped by
+   * source and destination archetype, so each group migrates at once. Commands are applied in
+   * the order of their origin (system, archetype and chunk, commands recorded outside of systems
+   * first) and then in recording order, so the spawned ids and the last set of a component do
+   * not depend on the thread that ran each chunk
+   */
+  void flush_commands();
+
   /*! @brief Returns the amount of registered components */
   std::size_t count_components();
 
@@ -135,6 +323,9 @@ public:
   template <typename ...T>
   ArchetypeId get_archetype_id();
 
+  /*! @brief Returns the pool used for running the systems (can be used with View::par_each) */
+  ThreadPool &get_thread_pool() { return pool; }
+
   /*! @brief Returns the id associated with the component type */
   template <typename Component>
   ComponentId get_component_id() { return ids.get_component_id<Component>(); }
@@ -146,6 +337,21 @@ private:
   /*! @brief Creates the columns for all the components of the archetype */
   void create_archetype_columns(archetype_t archetype);
 
+  /*!
+   * @brief Returns the archetype reached by adding or removing a component, the first
+   * transition registers the target archetype and caches the edge in both directions
+   */
+  archetype_t find_transition(archetype_t archetype, ComponentId component, bool add);
+
+  /*!
+   * @brief Moves a batch of entities from the same archetype to another, the rows are
+   * split in contiguous runs (from the last one) and each run is migrated at once
+   */
+  void move_entities(archetype_t from, archetype_t to, const std::vector<EntityId> &entities);
+
+  /*! @brief Removes a row from an archetype and fixes the record of the entity moved into it */
+  void remove_row(archetype_t archetype, std::size_t row);
+
   /*! @brief Adds a node to the graph */
   archetype_t add_node(archetype_t archetype);
 
@@ -155,10 +361,69 @@ private:
   /*! @brief Adds a node to the graph */
   archetype_t add_node(std::vector<ComponentId> type);
 
-  /*! @brief Relation between and entity id with an archetype and a line */
-  std::unordered_map<EntityId, std::shared_ptr<Record>> entity_index;
+  /*!
+   * @brief Creates an archetype in the graph arena and stores it in the archetype table,
+   * its columns take their chunks from the pool
+   */
+  archetype_t make_archetype(ArchetypeId id, std::vector<ComponentId> type);
+
+  /*! @brief Destroys an archetype and clears its slot in the archetype table */
+  void destroy_archetype(archetype_t archetype);
+
+  /*! @brief Returns the record of a live entity, nullptr for stale or unknown handles */
+  Record *find_record(EntityId entity) {
+    uint32_t slot { entity_slot(entity) };
+    if (entity == 0 || slot >= entity_index.size() || entity_index[slot].entity != entity) {
+      return nullptr;
+    }
+    return &entity_index[slot];
+  }
+
+  /*! @brief Returns the archetype of a component list, registering it when needed */
+  template <typename ...Components>
+  archetype_t get_archetype();
+
+  /*! @brief Returns the column of a component in an archetype */
+  Column &get_column(archetype_t archetype, ComponentId component) {
+    return *archetype->find_column(component);
+  }
+
+  /*! @brief Returns the component of the entity of a record, nullptr when its archetype does not have it */
+  template <typename T>
+  T *find_component(const Record &record) {
+    static_assert(!is_split_component_v<std::remove_const_t<T>>, "split components are not addressable, use get_component");
+    Column *column { record.archetype->find_column(ids.get_component_id<T>()) };
+    return column == nullptr ? nullptr : static_cast<T*>(column->get(record.row));
+  }
+
+  /*! @brief Makes the record of an entity point to its row */
+  void set_record(EntityId entity, archetype_t archetype, std::size_t row) {
+    uint32_t slot { entity_slot(entity) };
+    if (slot >= entity_index.size()) {
+      entity_index.resize(slot + 1);
+    }
+    Record &entity_record { entity_index[slot] };
+    entity_record.archetype = archetype;
+    entity_record.row = row;
+    entity_record.entity = entity;
+  }
+
+  /*! @brief Arena of the archetypes, their edges and control blocks, only released as a whole */
+  std::pmr::monotonic_buffer_resource graph_arena;
+  /*! @brief Fixed size blocks for the chunks of the columns */
+  ChunkPool chunk_pool;
+  /*! @brief Pool for the nodes and buffers of the indices */
+  std::pmr::unsynchronized_pool_resource index_pool;
+  /*! @brief Relation between and entity slot with an archetype and a line */
+  std::pmr::vector<Record> entity_index { &index_pool };
+  /*!
+   * @brief Splits the systems into stages, a system goes one stage after the last
+   * stage holding a conflicting system registered before it
+   */
+  void build_schedule();
+
   /* @brief Auxiliary class for system creation */
-  SystemCreator sys { component_archetype_mapping, ids, archetype_index };
+  SystemCreator sys { component_archetype_mapping, ids, archetype_table, system_index };
   /*! @brief The class that generates the new ids, exists for composition purposes */
   IdController ids { };
   /*!
@@ -166,77 +431,225 @@ private:
    * in the database
    */
   /*! @brief Mapping from each components and its associated archetypes */
-  std::unordered_map<ComponentId, std::shared_ptr<ArchetypeMap>> component_archetype_mapping;
-  /*! @brief Maps a component id with its size */
-  std::unordered_map<ComponentId, std::size_t> component_size_index;
+  std::pmr::unordered_map<ComponentId, ArchetypeMap> component_archetype_mapping { &index_pool };
+  /*! @brief Maps a component id with its lifecycle (size, construction, moves, destruction) */
+  std::unordered_map<ComponentId, ComponentInfo> component_info_index;
   /*! @brief Relation between a system id and a system */
   std::map<SystemId, SystemBase*> system_index;
+  /*! @brief Systems grouped by the stage they run in */
+  std::vector<std::vector<SystemBase*>> schedule;
+  /*! @brief Set when the systems changed and the schedule must be rebuilt */
+  bool schedule_dirty { true };
+  /*! @brief Pool that runs the systems of a stage */
+  ThreadPool pool;
+  /*! @brief One command buffer per thread of the pool */
+  std::vector<std::unique_ptr<CommandBuffer>> command_buffers;
   /*! @brief List of disabled systems */
   std::unordered_set<SystemId> disabled_systems_index;
-  /*! @brief Relationship between a list of components and the archetypes */
-  std::unordered_map<ArchetypeId, archetype_t> archetype_index;
+  /*!
+   * @brief Owner of every archetype (the nodes of the graph included) by id, nullptr once
+   * destroyed. The archetypes themselves live in the graph arena
+   */
+  std::pmr::vector<archetype_t> archetype_table { &index_pool };
+  /*! @brief The registered archetypes (the ones with columns), contiguous for iteration */
+  std::pmr::vector<archetype_t> registered_archetypes { &index_pool };
+  /*! @brief Archetypes holding components with destructors, the only ones visited on a reset */
+  std::pmr::vector<archetype_t> non_trivial_archetypes { &index_pool };
+  /*! @brief Relationship between a canonical (sorted) signature and its archetype */
+  std::pmr::unordered_map<ArchetypeSignature, archetype_t, VectorHasher<ComponentId>> signature_index { &index_pool };
   /*! @brief All the registered components and their depth in the graph */
-  std::unordered_map<depth_t, std::tuple<archetype_t, dependencies_t>> depth_index;
+  std::pmr::unordered_map<depth_t, std::tuple<archetype_t, dependencies_t>> depth_index { &index_pool };
   /*! @brief An archetype id list */
   TypeMapper<ArchetypeId> archetype_ids;
   /*! @brief Root archetype of the graph */
-  archetype_t root { new Archetype {0, std::vector<ComponentId>()} };
+  archetype_t root { make_archetype(0, std::vector<ComponentId>()) };
   /*! @brief The controller for the graph operations */
   //GraphController graph {root};
   /*!
    * @brief Represents the internal abstractions of cycles
-   * (relates mainly to the systems that should run each tick)
+   * (relates mainly to the systems that should run each tick), the cycle goes back
+   * to 0 after this amount of ticks. Registering a system raises it to the least common
+   * multiple with the tick rate, so every rate divides it (0 when that overflows, the cycle
+   * then never goes back)
    */
   uint64_t cycle_reset;
   /*! @brief The cycle the world is currently in */
-  uint64_t cycle;
+  uint64_t cycle { 0 };
+#ifdef ECS_PROFILING
+  /*! @brief Timings of the systems */
+  Profiler profiler;
+#endif
 };
 
 template <typename Component>
 ComponentId WorldRegistry::register_component() {
+  if (ids.get_component_amount() + 1 >= ComponentMask::capacity) {
+    throw std::exception();
+  }
   ids.insert_component_id<Component>();
-  component_size_index[ids.get_component_id<Component>()] = sizeof(Component);
+  component_info_index.insert_or_assign(ids.get_component_id<Component>(), ComponentInfo::of<Component>());
   return ids.get_component_id<Component>();
 }
 
 template <typename ...Components>
-EntityId WorldRegistry::create_entity() {
-  EntityId new_entity = ids.gen_entity_id();
+archetype_t WorldRegistry::get_archetype() {
   if (!archetype_ids.contains<Components...>()) {
     register_archetype<Components...>();
   }
   ArchetypeId archetype_id { archetype_ids.find<Components...>()->second };
-  archetype_t archetype { archetype_index[archetype_id] };
-  std::shared_ptr<Record> entity_record { new Record {} };
-  entity_record->archetype = archetype;
-  entity_record->row = archetype->assign_row();
-  entity_index[new_entity] = entity_record;
+  return archetype_table[archetype_id];
+}
+
+template <typename ...Components>
+EntityId WorldRegistry::create_entity() {
+  EntityId new_entity = ids.gen_entity_id();
+  archetype_t archetype { get_archetype<Components...>() };
+  set_record(new_entity, archetype, archetype->assign_row(new_entity));
   return new_entity;
 }
 
+template <typename ...Components>
+std::vector<EntityId> WorldRegistry::create_entities(std::size_t amount) {
+  archetype_t archetype { get_archetype<Components...>() };
+  std::vector<EntityId> new_entities(amount);
+  uint32_t max_slot { 0 };
+  for (EntityId &entity: new_entities) {
+    entity = ids.gen_entity_id();
+    max_slot = std::max(max_slot, entity_slot(entity));
+  }
+  if (max_slot >= entity_index.size()) {
+    entity_index.resize(max_slot + 1);
+  }
+  std::size_t row { archetype->assign_rows(new_entities) };
+  for (EntityId entity: new_entities) {
+    set_record(entity, archetype, row++);
+  }
+  return new_entities;
+}
+
+template <typename ...Components>
+std::vector<EntityId> WorldRegistry::create_entities(std::span<const Components> ...components) {
+  std::size_t amount { std::get<0>(std::make_tuple(components.size()...)) };
+  if (((components.size() != amount) || ...)) {
+    throw std::exception();
+  }
+  std::vector<EntityId> new_entities { create_entities<Components...>(amount) };
+  if (amount == 0) {
+    return new_entities;
+  }
+  Record &first { entity_index[entity_slot(new_entities[0])] };
+  ([&] {
+    get_column(first.archetype, ids.get_component_id<Components>()).insert(components.data(), first.row, amount);
+  } (), ...);
+  return new_entities;
+}
+
+template <typename ...Components, typename Generator>
+std::vector<EntityId> WorldRegistry::create_entities(std::size_t amount, Generator generator) {
+  std::vector<EntityId> new_entities { create_entities<Components...>(amount) };
+  if (amount == 0) {
+    return new_entities;
+  }
+  Record &first { entity_index[entity_slot(new_entities[0])] };
+  std::array<Column*, sizeof...(Components)> columns { &get_column(first.archetype, ids.get_component_id<Components>())... };
+  columns[0]->for_each_range(first.row, amount, [&] (uint8_t *, std::size_t offset, std::size_t rows) {
+    std::tuple<Components*...> chunk_ptrs;
+    std::size_t j { 0 };
+    ([&] {
+      std::get<Components*>(chunk_ptrs) = static_cast<Components*>(columns[j]->get(first.row + offset));
+      ++j;
+    } (), ...);
+    for (std::size_t i = 0; i < rows; ++i) {
+      std::tuple<Components...> values { generator(offset + i) };
+      std::size_t k { 0 };
+      ([&] {
+        if constexpr (is_split_component_v<Components>) {
+          columns[k]->write(first.row + offset + i, &std::get<Components>(values));
+        } else {
+          std::get<Components*>(chunk_ptrs)[i] = std::move(std::get<Components>(values));
+        }
+        ++k;
+      } (), ...);
+    }
+  });
+  return new_entities;
+}
+
 template <typename ...T>
 std::optional<ArchetypeId> WorldRegistry::register_archetype() {
-  ArchetypeId arch_id = ids.gen_archetype_id();
-  archetype_ids.put<T...>(arch_id);
-  archetype_t new_archetype { new Archetype(arch_id, ids.make_archetype_signature<T...>()) };
-  archetype_index[arch_id] = new_archetype;
-  add_node(new_archetype);
-  create_component_archetype_mapping(new_archetype);
-  create_archetype_columns(new_archetype);
-  return std::make_optional(arch_id);
+  ArchetypeSignature signature { ids.make_archetype_signature<T...>() };
+  archetype_t new_archetype { register_archetype(signature) };
+  archetype_ids.put<T...>(new_archetype->get_id());
+  return std::make_optional(new_archetype->get_id());
 }
 
 template <typename ...T, typename Func>
-const SystemId WorldRegistry::register_system(Func system) {
-  std::function<void(T*...)> wrapped_function { system };
-  SystemBase *sys_class = sys.create_system<T...>(ids.gen_system_id(), wrapped_function);
+const SystemId WorldRegistry::register_system(Func system, uint64_t tick_rate) {
+  if (tick_rate == 0) {
+    throw std::exception();
+  }
+  SystemBase *sys_class = sys.create_system<T...>(ids.gen_system_id(), std::move(system), tick_rate);
   if (sys_class == nullptr) {
     throw std::exception();
   }
+  uint64_t same_rate { 0 };
+  for (auto [_, registered]: system_index) {
+    if (registered->get_tick() == tick_rate)
+      ++same_rate;
+  }
+  sys_class->set_phase(same_rate % tick_rate);
+  uint64_t common { std::gcd(cycle_reset, tick_rate) };
+  if (cycle_reset != 0 && cycle_reset / common > UINT64_MAX / tick_rate) {
+    cycle_reset = 0;
+  } else {
+    cycle_reset = cycle_reset / common * tick_rate;
+  }
   system_index[sys_class->get_id()] = sys_class;
+#ifdef ECS_PROFILING
+  profiler.add_system(sys_class->get_id());
+#endif
+  schedule_dirty = true;
   return sys_class->get_id();
 }
 
+template <typename ...Components>
+View<Components...> WorldRegistry::view() {
+  std::array<ComponentId, sizeof...(Components)> components { ids.get_component_id<std::remove_const_t<Components>>()... };
+  std::array<ArchetypeMap*, sizeof...(Components)> maps;
+  for (std::size_t i = 0; i < components.size(); ++i) {
+    auto mapping = component_archetype_mapping.find(components[i]);
+    if (mapping == component_archetype_mapping.end()) {
+      return View<Components...>({});
+    }
+    maps[i] = &mapping->second;
+  }
+  std::size_t smallest { 0 };
+  for (std::size_t i = 1; i < maps.size(); ++i) {
+    if (maps[i]->size() < maps[smallest]->size())
+      smallest = i;
+  }
+  ComponentMask mask { std::vector<ComponentId>(components.begin(), components.end()) };
+  std::vector<typename View<Components...>::Entry> entries;
+  for (auto [archetype_id, _]: *maps[smallest]) {
+    typename View<Components...>::Entry entry { archetype_table[archetype_id], {} };
+    if (entry.archetype == nullptr || !entry.archetype->get_mask().contains(mask)) {
+      continue;
+    }
+    for (std::size_t i = 0; i < maps.size(); ++i) {
+      entry.columns[i] = &(*entry.archetype)[(*maps[i])[archetype_id]];
+    }
+    entries.push_back(entry);
+  }
+  return View<Components...>(std::move(entries));
+}
+
+template <typename ...T, typename Func>
+const SystemId WorldRegistry::register_parallel_system(Func system, uint64_t tick_rate) {
+  SystemId system_id { register_system<T...>(std::move(system), tick_rate) };
+  system_index[system_id]->set_thread_pool(&pool);
+  return system_id;
+}
+
 template <typename ...T>
 ArchetypeId WorldRegistry::get_archetype_id() {
   return archetype_ids.find<T...>()->second;
@@ -245,95 +658,122 @@ ArchetypeId WorldRegistry::get_archetype_id() {
 template <typename ...T>
 void WorldRegistry::add_archetype(EntityId entity) {
   ArchetypeId arch_id { archetype_ids.find<T...>()->second };
-  archetype_t archetype { archetype_index[arch_id] };
+  archetype_t archetype { archetype_table[arch_id] };
 }
 
 template <typename T>
 std::optional<T> WorldRegistry::get_component(EntityId entity) {
-  if (entity_index[entity] == nullptr) {
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
     return std::nullopt;
   }
-  std::shared_ptr<Record> record { entity_index[entity] };
-  archetype_t archetype { record->archetype };
-  ComponentId component_id = ids.get_component_id<T>();
-  std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[component_id] };
-  if (archetype_map->count(archetype->get_id()) == 0) {
+  Column *column { record->archetype->find_column(ids.get_component_id<T>()) };
+  if (column == nullptr) {
     return std::nullopt;
   }
-  ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-  return std::make_optional((*archetype)[a_record].get<T>(record->row));
+  return std::make_optional(column->get<T>(record->row));
+}
+
+template <typename T>
+T *WorldRegistry::try_get(EntityId entity) {
+  Record *record { find_record(entity) };
+  return record == nullptr ? nullptr : find_component<T>(*record);
+}
+
+template <typename ...Components>
+std::tuple<Components*...> WorldRegistry::get(EntityId entity) {
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
+    return { static_cast<Components*>(nullptr)... };
+  }
+  return { find_component<Components>(*record)... };
 }
 
 template <typename T>
 void WorldRegistry::attach_component(EntityId entity, T component) {
-  std::shared_ptr<Record> record { entity_index[entity] };
-  archetype_t archetype { record->archetype };
-  ComponentId component_id = ids.get_component_id<T>();
-  std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[component_id] };
-  ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-  (*archetype)[a_record].insert(component, record->row);
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
+    return;
+  }
+  Column *column { record->archetype->find_column(ids.get_component_id<T>()) };
+  if (column == nullptr) {
+    return;
+  }
+  column->insert(std::move(component), record->row);
 }
 
 template <typename T>
 archetype_t WorldRegistry::add_component(EntityId entity) {
-  std::shared_ptr<Record> record = entity_index[entity];
-  archetype_t &current_archetype = record->archetype;
-  std::vector<ComponentId> new_signature = current_archetype->get_type();
-  std::vector<ComponentId> old_signature = current_archetype->get_type();
-  ComponentId component = ids.get_component_id<T>();
-  new_signature.push_back(component);
-  archetype_t new_archetype;
-  auto indexed_archetype = current_archetype->get_edges()[component];
-  if (indexed_archetype == nullptr) {
-    new_archetype = register_archetype(new_signature);
-  } else {
-    new_archetype = std::get<archetype_t>(indexed_archetype->add);
-  }
-  std::vector<void*> components;
-  for (ComponentId component: old_signature) {
-    components.push_back(get_component(entity, component));
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
+    return nullptr;
   }
-  current_archetype->remove_dependent_type();
-  new_archetype->insert_dependent_type();
-  record->archetype = new_archetype;
-  record->row = new_archetype->assign_row();
-  int i = 0;
-  for (ComponentId component: old_signature) {
-    attach_component(entity, component, components[i]);
-    ++i;
+  archetype_t current_archetype = record->archetype;
+  ComponentId component = ids.get_component_id<T>();
+  if (current_archetype->get_mask().test(component)) {
+    return current_archetype;
   }
+  archetype_t new_archetype { find_transition(current_archetype, component, true) };
+  migrate_rows(record->archetype, record->row, 1, new_archetype);
   return new_archetype;
 }
 
 template<typename T>
 archetype_t WorldRegistry::remove_component(EntityId entity) {
-  std::shared_ptr<Record> record = entity_index[entity];
-  archetype_t &current_archetype = record->archetype;
-  std::vector<ComponentId> new_signature = current_archetype->get_type();
-  std::vector<ComponentId> old_signature = current_archetype->get_type();
-  ComponentId component = ids.get_component_id<T>();
-  auto comp_it = std::find(new_signature.begin(), new_signature.end(), component);
-  new_signature.erase(comp_it);
-  archetype_t new_archetype;
-  auto indexed_archetype = current_archetype->get_edges()[component];
-  if (indexed_archetype == nullptr) {
-    new_archetype = register_archetype(new_signature);
-  } else {
-    new_archetype = std::get<archetype_t>(indexed_archetype->remove);
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
+    return nullptr;
   }
-  std::vector<void*> components;
-  for (ComponentId component: new_signature) {
-    components.push_back(get_component(entity, component));
-  }
-  current_archetype->remove_dependent_type();
-  new_archetype->insert_dependent_type();
-  record->archetype = new_archetype;
-  record->row = new_archetype->assign_row();
-  int i = 0;
-  for (ComponentId component: new_signature) {
-    attach_component(entity, component, components[i]);
-    ++i;
+  archetype_t current_archetype = record->archetype;
+  ComponentId component = ids.get_component_id<T>();
+  if (!current_archetype->get_mask().test(component)) {
+    return current_archetype;
   }
+  archetype_t new_archetype { find_transition(current_archetype, component, false) };
+  migrate_rows(record->archetype, record->row, 1, new_archetype);
   return new_archetype;
 }
 
+template<typename T, typename ...Filter>
+std::size_t WorldRegistry::add_component(const View<Filter...> &query, T value) {
+  ComponentId component = ids.get_component_id<T>();
+  std::size_t amount { 0 };
+  for (auto &entry: query.get_entries()) {
+    archetype_t archetype { entry.archetype };
+    std::size_t rows { archetype->size() };
+    if (rows == 0 || archetype->get_mask().test(component)) {
+      continue;
+    }
+    archetype_t target { find_transition(archetype, component, true) };
+    std::size_t first { target->size() };
+    migrate_rows(archetype, 0, rows, target);
+    Column &column { get_column(target, component) };
+    if constexpr (is_split_component_v<T>) {
+      for (std::size_t row = first; row < first + rows; ++row) {
+        column.write(row, &value);
+      }
+    } else {
+      column.for_each_range(first, rows, [&] (uint8_t *dst, std::size_t, std::size_t count) {
+        std::fill_n(reinterpret_cast<T*>(dst), count, value);
+      });
+    }
+    amount += rows;
+  }
+  return amount;
+}
+
+template<typename T, typename ...Filter>
+std::size_t WorldRegistry::remove_component(const View<Filter...> &query) {
+  ComponentId component = ids.get_component_id<T>();
+  std::size_t amount { 0 };
+  for (auto &entry: query.get_entries()) {
+    archetype_t archetype { entry.archetype };
+    std::size_t rows { archetype->size() };
+    if (rows == 0 || !archetype->get_mask().test(component)) {
+      continue;
+    }
+    migrate_rows(archetype, 0, rows, find_transition(archetype, component, false));
+    amount += rows;
+  }
+  return amount;
+}
@@ -5,14 +5,14 @@ ArchetypeId Archetype::get_id()
   return id;
 }
 
-std::map<ComponentId, std::shared_ptr<ArchetypeEdge>> &Archetype::get_edges()
+std::pmr::vector<ArchetypeEdge> &Archetype::get_edges()
 {
   return edges;
 }
 
 ArchetypeSignature Archetype::get_type()
 {
-  return type;
+  return ArchetypeSignature(type.begin(), type.end());
 }
 
 Column& Archetype::operator[](std::size_t index)
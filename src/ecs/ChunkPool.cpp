@@ -0,0 +1,49 @@
+#include "ChunkPool.hpp"
+#include <algorithm>
+
+std::size_t ChunkPool::block_size(std::size_t bytes, std::size_t alignment) {
+  std::size_t size { std::max(bytes, sizeof(void*)) };
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+void *ChunkPool::do_allocate(std::size_t bytes, std::size_t alignment) {
+  std::size_t size { block_size(bytes, alignment) };
+  Pool &pool { pools[{ size, alignment }] };
+  void *block;
+  if (pool.free != nullptr) {
+    block = pool.free;
+    pool.free = *static_cast<void**>(block);
+  } else {
+    if (pool.next == pool.end) {
+      pool.slab_size = std::max(size, slab_bytes / size * size);
+      std::byte *slab { static_cast<std::byte*>(upstream->allocate(pool.slab_size, alignment)) };
+      pool.slabs.push_back(slab);
+      pool.next = slab;
+      pool.end = slab + pool.slab_size;
+      reserved += pool.slab_size;
+    }
+    block = pool.next;
+    pool.next += size;
+  }
+  handed_out += size;
+  return block;
+}
+
+void ChunkPool::do_deallocate(void *block, std::size_t bytes, std::size_t alignment) {
+  std::size_t size { block_size(bytes, alignment) };
+  Pool &pool { pools.at({ size, alignment }) };
+  *static_cast<void**>(block) = pool.free;
+  pool.free = block;
+  handed_out -= size;
+}
+
+void ChunkPool::release() {
+  for (auto &[key, pool]: pools) {
+    for (std::byte *slab: pool.slabs) {
+      upstream->deallocate(slab, pool.slab_size, key.second);
+    }
+  }
+  pools.clear();
+  reserved = 0;
+  handed_out = 0;
+}
@@ -0,0 +1,172 @@
+#include "Kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ECS_KERNELS_X86 1
+#endif
+
+namespace {
+#if defined(ECS_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ECS_KERNELS_AVX2 1
+
+__attribute__((target("avx2,fma")))
+void axpy_avx2(float *__restrict y, const float *__restrict x, float a, std::size_t amount) {
+  __m256 factor { _mm256_set1_ps(a) };
+  std::size_t i { 0 };
+  for (; i + 16 <= amount; i += 16) {
+    __m256 y0 { _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)) };
+    __m256 y1 { _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)) };
+    _mm256_storeu_ps(y + i, y0);
+    _mm256_storeu_ps(y + i + 8, y1);
+  }
+  for (; i < amount; ++i) {
+    y[i] += a * x[i];
+  }
+}
+
+__attribute__((target("avx2,fma")))
+void scale_avx2(float *__restrict y, float a, std::size_t amount) {
+  __m256 factor { _mm256_set1_ps(a) };
+  std::size_t i { 0 };
+  for (; i + 8 <= amount; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_mul_ps(factor, _mm256_loadu_ps(y + i)));
+  }
+  for (; i < amount; ++i) {
+    y[i] *= a;
+  }
+}
+
+__attribute__((target("avx2,fma")))
+float dot_avx2(const float *__restrict x, const float *__restrict y, std::size_t amount) {
+  __m256 sum0 { _mm256_setzero_ps() };
+  __m256 sum1 { _mm256_setzero_ps() };
+  std::size_t i { 0 };
+  for (; i + 16 <= amount; i += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), sum1);
+  }
+  __m256 sum { _mm256_add_ps(sum0, sum1) };
+  __m128 half { _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)) };
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  float result { _mm_cvtss_f32(half) };
+  for (; i < amount; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+/*! @brief Checks the CPU once */
+bool has_avx2() {
+  static const bool supported { __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") };
+  return supported;
+}
+#endif
+
+#if defined(__SSE2__)
+#define ECS_KERNELS_SSE2 1
+
+void axpy_sse2(float *__restrict y, const float *__restrict x, float a, std::size_t amount) {
+  __m128 factor { _mm_set1_ps(a) };
+  std::size_t i { 0 };
+  for (; i + 4 <= amount; i += 4) {
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(factor, _mm_loadu_ps(x + i))));
+  }
+  for (; i < amount; ++i) {
+    y[i] += a * x[i];
+  }
+}
+
+void scale_sse2(float *__restrict y, float a, std::size_t amount) {
+  __m128 factor { _mm_set1_ps(a) };
+  std::size_t i { 0 };
+  for (; i + 4 <= amount; i += 4) {
+    _mm_storeu_ps(y + i, _mm_mul_ps(factor, _mm_loadu_ps(y + i)));
+  }
+  for (; i < amount; ++i) {
+    y[i] *= a;
+  }
+}
+
+float dot_sse2(const float *__restrict x, const float *__restrict y, std::size_t amount) {
+  __m128 sum { _mm_setzero_ps() };
+  std::size_t i { 0 };
+  for (; i + 4 <= amount; i += 4) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+  }
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  float result { _mm_cvtss_f32(sum) };
+  for (; i < amount; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+#endif
+}
+
+const char *kernel_isa() {
+#if defined(ECS_KERNELS_AVX2)
+  if (has_avx2())
+    return "avx2";
+#endif
+#if defined(ECS_KERNELS_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+void axpy(float *__restrict y, const float *__restrict x, float a, std::size_t amount) {
+#if defined(ECS_KERNELS_AVX2)
+  if (has_avx2())
+    return axpy_avx2(y, x, a, amount);
+#endif
+#if defined(ECS_KERNELS_SSE2)
+  axpy_sse2(y, x, a, amount);
+#else
+  axpy_scalar(y, x, a, amount);
+#endif
+}
+
+void scale(float *__restrict y, float a, std::size_t amount) {
+#if defined(ECS_KERNELS_AVX2)
+  if (has_avx2())
+    return scale_avx2(y, a, amount);
+#endif
+#if defined(ECS_KERNELS_SSE2)
+  scale_sse2(y, a, amount);
+#else
+  for (std::size_t i = 0; i < amount; ++i) {
+    y[i] *= a;
+  }
+#endif
+}
+
+float dot(const float *__restrict x, const float *__restrict y, std::size_t amount) {
+#if defined(ECS_KERNELS_AVX2)
+  if (has_avx2())
+    return dot_avx2(x, y, amount);
+#endif
+#if defined(ECS_KERNELS_SSE2)
+  return dot_sse2(x, y, amount);
+#else
+  float result { 0 };
+  for (std::size_t i = 0; i < amount; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+#endif
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("no-tree-vectorize")))
+#endif
+void axpy_scalar(float *__restrict y, const float *__restrict x, float a, std::size_t amount) {
+#if defined(__clang__)
+#pragma clang loop vectorize(disable)
+#endif
+  for (std::size_t i = 0; i < amount; ++i) {
+    y[i] += a * x[i];
+  }
+}
@@ -0,0 +1,100 @@
+#include "MemoryStats.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+/*! @brief Formats bytes with a binary unit */
+std::string format_bytes(std::size_t bytes) {
+  const char *units[] { "B", "KiB", "MiB", "GiB", "TiB" };
+  double value { static_cast<double>(bytes) };
+  std::size_t unit { 0 };
+  while (value >= 1024.0 && unit + 1 < std::size(units)) {
+    value /= 1024.0;
+    ++unit;
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+  return text;
+}
+
+/*! @brief Returns the percentage of the reserved bytes that are used */
+int fill(std::size_t used, std::size_t reserved) {
+  return reserved == 0 ? 100 : static_cast<int>(100 * used / reserved);
+}
+}
+
+std::size_t MemoryStats::reserved() const {
+  std::size_t total { 0 };
+  for (const ArchetypeMemory &archetype: archetypes) {
+    total += archetype.reserved;
+  }
+  return total;
+}
+
+std::size_t MemoryStats::used() const {
+  std::size_t total { 0 };
+  for (const ArchetypeMemory &archetype: archetypes) {
+    total += archetype.used;
+  }
+  return total;
+}
+
+std::size_t MemoryStats::overhead() const {
+  std::size_t total { 0 };
+  for (const ArchetypeMemory &archetype: archetypes) {
+    total += archetype.overhead;
+  }
+  for (const IndexMemory &index: indices) {
+    total += index.bytes;
+  }
+  return total;
+}
+
+void MemoryStats::dump(std::ostream &out, std::size_t top) const {
+  char line[160];
+  std::snprintf(line, sizeof(line), "memory: %s reserved, %s used (%d%%), %s overhead, %zu archetypes\n",
+      format_bytes(reserved()).c_str(), format_bytes(used()).c_str(), fill(used(), reserved()),
+      format_bytes(overhead()).c_str(), archetypes.size());
+  out << line;
+
+  std::vector<const ArchetypeMemory*> wasteful;
+  for (const ArchetypeMemory &archetype: archetypes) {
+    wasteful.push_back(&archetype);
+  }
+  std::sort(wasteful.begin(), wasteful.end(), [] (const ArchetypeMemory *a, const ArchetypeMemory *b) {
+    return a->reserved - a->used > b->reserved - b->used;
+  });
+  if (wasteful.size() > top) {
+    wasteful.resize(top);
+  }
+  out << "archetypes by wasted bytes:\n";
+  std::snprintf(line, sizeof(line), "  %8s %10s %11s %11s %11s %5s  components\n",
+      "id", "entities", "reserved", "used", "wasted", "fill");
+  out << line;
+  for (const ArchetypeMemory *archetype: wasteful) {
+    std::string components;
+    for (const ColumnMemory &column: archetype->columns) {
+      components += (components.empty() ? "" : ",") + std::to_string(column.component);
+    }
+    std::snprintf(line, sizeof(line), "  %8llu %10zu %11s %11s %11s %4d%%  [",
+        static_cast<unsigned long long>(archetype->id), archetype->entities,
+        format_bytes(archetype->reserved).c_str(), format_bytes(archetype->used).c_str(),
+        format_bytes(archetype->reserved - archetype->used).c_str(), fill(archetype->used, archetype->reserved));
+    out << line << components << "]\n";
+  }
+
+  out << "components:\n";
+  for (const ComponentMemory &component: components) {
+    std::snprintf(line, sizeof(line), "  %8llu %10zu archetypes %11s %11s %4d%%\n",
+        static_cast<unsigned long long>(component.component), component.archetypes,
+        format_bytes(component.reserved).c_str(), format_bytes(component.used).c_str(),
+        fill(component.used, component.reserved));
+    out << line;
+  }
+
+  out << "indices:\n";
+  for (const IndexMemory &index: indices) {
+    std::snprintf(line, sizeof(line), "  %-28s %11s\n", index.name.c_str(), format_bytes(index.bytes).c_str());
+    out << line;
+  }
+}
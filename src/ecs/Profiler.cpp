@@ -0,0 +1,149 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+/*! @brief Writes a string as a JSON string literal */
+void write_json_string(std::ostream &out, const std::string &value) {
+  out << '"';
+  for (char c: value) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out << escaped;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+/*! @brief Writes a time in nanoseconds as the microseconds of the trace format */
+void write_microseconds(std::ostream &out, int64_t ns) {
+  out << ns / 1000 << '.';
+  char fraction[8];
+  std::snprintf(fraction, sizeof(fraction), "%03d", static_cast<int>(ns % 1000));
+  out << fraction;
+}
+}
+
+Profiler::Profiler(std::size_t capacity)
+    : capacity{capacity > 0 ? capacity : 1}, epoch{std::chrono::steady_clock::now()}
+{
+  ticks.label = "tick";
+  ticks.samples.resize(this->capacity);
+}
+
+void Profiler::add_system(SystemId system) {
+  Ring &ring { rings[system] };
+  ring.label = "system " + std::to_string(system);
+  ring.samples.resize(capacity);
+}
+
+void Profiler::set_label(SystemId system, std::string label) {
+  rings.at(system).label = std::move(label);
+}
+
+const std::string &Profiler::get_label(SystemId system) const {
+  return rings.at(system).label;
+}
+
+uint64_t Profiler::begin_tick() {
+  return ++tick;
+}
+
+void Profiler::end_tick(int64_t start_ns) {
+  push(ticks, SystemSample { tick, start_ns, now() - start_ns, 0, 0, 0 });
+}
+
+void Profiler::record(SystemId system, const SystemSample &sample) {
+  push(rings.at(system), sample);
+}
+
+std::vector<SystemSample> Profiler::get_samples(SystemId system) const {
+  return ordered(rings.at(system));
+}
+
+std::optional<SystemTimings> Profiler::get_timings(SystemId system) const {
+  return timings(rings.at(system));
+}
+
+std::optional<SystemTimings> Profiler::get_tick_timings() const {
+  return timings(ticks);
+}
+
+void Profiler::export_chrome_trace(std::ostream &out) const {
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first { true };
+  auto write_event = [&] (const std::string &label, const char *category, const SystemSample &sample) {
+    if (!first)
+      out << ',';
+    first = false;
+    out << "{\"name\":";
+    write_json_string(out, label);
+    out << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << sample.thread << ",\"ts\":";
+    write_microseconds(out, sample.start_ns);
+    out << ",\"dur\":";
+    write_microseconds(out, sample.duration_ns);
+    out << ",\"args\":{\"tick\":" << sample.tick << ",\"entities\":" << sample.entities
+        << ",\"archetypes\":" << sample.archetypes << "}}";
+  };
+  for (const SystemSample &sample: ordered(ticks)) {
+    write_event(ticks.label, "tick", sample);
+  }
+  for (auto &[system, ring]: rings) {
+    for (const SystemSample &sample: ordered(ring)) {
+      write_event(ring.label, "system", sample);
+    }
+  }
+  out << "]}";
+}
+
+void Profiler::clear() {
+  for (auto &[system, ring]: rings) {
+    ring.next = 0;
+    ring.count = 0;
+  }
+  ticks.next = 0;
+  ticks.count = 0;
+}
+
+int64_t Profiler::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::push(Ring &ring, const SystemSample &sample) {
+  ring.samples[ring.next] = sample;
+  ring.next = (ring.next + 1) % capacity;
+  if (ring.count < capacity)
+    ++ring.count;
+}
+
+std::vector<SystemSample> Profiler::ordered(const Ring &ring) const {
+  std::vector<SystemSample> samples;
+  samples.reserve(ring.count);
+  std::size_t oldest { (ring.next + capacity - ring.count) % capacity };
+  for (std::size_t i = 0; i < ring.count; ++i) {
+    samples.push_back(ring.samples[(oldest + i) % capacity]);
+  }
+  return samples;
+}
+
+std::optional<SystemTimings> Profiler::timings(const Ring &ring) const {
+  if (ring.count == 0) {
+    return std::nullopt;
+  }
+  std::vector<int64_t> durations;
+  durations.reserve(ring.count);
+  int64_t total { 0 };
+  for (const SystemSample &sample: ordered(ring)) {
+    durations.push_back(sample.duration_ns);
+    total += sample.duration_ns;
+  }
+  std::sort(durations.begin(), durations.end());
+  std::size_t p99 { (durations.size() * 99 + 99) / 100 - 1 };
+  return SystemTimings { durations.size(), durations.front(), total / static_cast<int64_t>(durations.size()),
+                         durations[p99], durations.back() };
+}
@@ -0,0 +1,282 @@
+#include "WorldRegistry.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/*! @brief First bytes of every snapshot */
+constexpr char snapshot_magic[8] { 'E', 'C', 'S', 'S', 'N', 'A', 'P', '\0' };
+
+/*! @brief Writes a snapshot in order, keeping track of the offset for the padding */
+class SnapshotWriter {
+public:
+  SnapshotWriter(std::ofstream &out) : out{out} {};
+
+  /*! @brief Writes an array of trivially copyable values */
+  template <typename T>
+  void write(const T *values, std::size_t amount) {
+    out.write(reinterpret_cast<const char*>(values), amount * sizeof(T));
+    offset += amount * sizeof(T);
+  }
+
+  /*! @brief Writes zeroes up to the next multiple of the alignment */
+  void pad(std::size_t alignment) {
+    static const char zeroes[snapshot_alignment] {};
+    std::size_t padding { (alignment - offset % alignment) % alignment };
+    out.write(zeroes, padding);
+    offset += padding;
+  }
+
+private:
+  std::ofstream &out;
+  std::size_t offset { 0 };
+};
+
+/*! @brief Read only mapping of a whole file, unmapped when destroyed */
+class MappedFile {
+public:
+  MappedFile(const std::string &path) {
+    int fd { ::open(path.c_str(), O_RDONLY) };
+    if (fd < 0) {
+      throw std::exception();
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+      ::close(fd);
+      throw std::exception();
+    }
+    size = static_cast<std::size_t>(status.st_size);
+    void *mapping { ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      throw std::exception();
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL | MADV_WILLNEED);
+    data = static_cast<const uint8_t*>(mapping);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    ::munmap(const_cast<uint8_t*>(data), size);
+  }
+
+  const uint8_t *data;
+  std::size_t size;
+};
+
+/*! @brief Reads a mapped snapshot in order, the arrays are views of the mapping */
+class SnapshotReader {
+public:
+  SnapshotReader(const MappedFile &file) : file{file} {};
+
+  /*! @brief Returns the next array of values, throws when it goes past the end of the file */
+  template <typename T>
+  std::span<const T> read(std::size_t amount) {
+    if (amount > (file.size - offset) / sizeof(T)) {
+      throw std::exception();
+    }
+    std::span<const T> values { reinterpret_cast<const T*>(file.data + offset), amount };
+    offset += amount * sizeof(T);
+    return values;
+  }
+
+  /*! @brief Returns the next value */
+  template <typename T>
+  const T &read() {
+    return read<T>(1)[0];
+  }
+
+  /*! @brief Skips the padding up to the next multiple of the alignment */
+  void align(std::size_t alignment) {
+    offset = std::min(file.size, (offset + alignment - 1) / alignment * alignment);
+  }
+
+private:
+  const MappedFile &file;
+  std::size_t offset { 0 };
+};
+
+/*! @brief Archetype of a snapshot, checked and ready to be loaded */
+struct SnapshotSection {
+  /*! @brief Components of the archetype, in the order of the images */
+  ArchetypeSignature signature;
+  /*! @brief Entity of each row */
+  std::span<const EntityId> entities;
+  /*! @brief Chunk images of each component, views of the mapping */
+  std::vector<const uint8_t*> images;
+};
+}
+
+void WorldRegistry::save_snapshot(const std::string &path) {
+  std::vector<ComponentId> components;
+  for (auto &[component, info]: component_info_index) {
+    components.push_back(component);
+  }
+  std::sort(components.begin(), components.end());
+  std::unordered_map<ComponentId, uint64_t> position;
+  std::vector<SnapshotComponent> table;
+  for (ComponentId component: components) {
+    const ComponentInfo &info { component_info_index.at(component) };
+    for (const SnapshotComponent &entry: table) {
+      if (entry.name_hash == info.name_hash)
+        throw std::exception();
+    }
+    position[component] = table.size();
+    table.push_back(SnapshotComponent { info.name_hash, info.size, info.alignment,
+                                        Column(info, component).get_chunk_bytes() });
+  }
+  std::vector<archetype_t> archetypes;
+  for (archetype_t archetype: registered_archetypes) {
+    if (archetype->size() == 0) {
+      continue;
+    }
+    for (ComponentId component: archetype->get_type()) {
+      if (!component_info_index.at(component).trivially_relocatable)
+        throw std::exception();
+    }
+    archetypes.push_back(archetype);
+  }
+
+  std::ofstream stream { path, std::ios::binary | std::ios::trunc };
+  if (!stream) {
+    throw std::exception();
+  }
+  SnapshotWriter out { stream };
+  const std::vector<EntityId> &free_entities { ids.get_free_entities() };
+  SnapshotHeader header { {}, snapshot_version, snapshot_byte_order, Column::chunk_rows, table.size(),
+                          archetypes.size(), ids.last_entity(), free_entities.size() };
+  std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+  out.write(&header, 1);
+  out.write(table.data(), table.size());
+  out.write(free_entities.data(), free_entities.size());
+  std::vector<uint8_t> image;
+  for (archetype_t archetype: archetypes) {
+    ArchetypeSignature type { archetype->get_type() };
+    SnapshotArchetype entry { type.size(), archetype->size() };
+    out.write(&entry, 1);
+    for (ComponentId component: type) {
+      out.write(&position.at(component), 1);
+    }
+    out.write(archetype->get_entities(0, archetype->size()).data(), archetype->size());
+    out.pad(snapshot_alignment);
+    for (std::size_t i = 0; i < type.size(); ++i) {
+      Column &column { (*archetype)[i] };
+      image.resize(column.get_chunk_bytes());
+      for (std::size_t chunk = 0; chunk < column.chunk_count(); ++chunk) {
+        column.copy_chunk(chunk, image.data());
+        out.write(image.data(), image.size());
+      }
+    }
+  }
+  stream.flush();
+  if (!stream) {
+    throw std::exception();
+  }
+}
+
+void WorldRegistry::load_snapshot(const std::string &path) {
+  MappedFile file { path };
+  SnapshotReader in { file };
+  const SnapshotHeader &header { in.read<SnapshotHeader>() };
+  if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 || header.version != snapshot_version
+      || header.byte_order != snapshot_byte_order || header.chunk_rows != Column::chunk_rows
+      || header.last_entity >= UINT32_MAX) {
+    throw std::exception();
+  }
+  std::unordered_map<uint64_t, ComponentId> by_name;
+  for (auto &[component, info]: component_info_index) {
+    by_name[info.name_hash] = component;
+  }
+  std::vector<ComponentId> components;
+  std::vector<std::size_t> chunk_bytes;
+  for (const SnapshotComponent &entry: in.read<SnapshotComponent>(header.components)) {
+    auto component = by_name.find(entry.name_hash);
+    if (component == by_name.end()) {
+      throw std::exception();
+    }
+    const ComponentInfo &info { component_info_index.at(component->second) };
+    std::size_t bytes { Column(info, component->second).get_chunk_bytes() };
+    if (info.size != entry.size || !info.trivially_relocatable || bytes != entry.chunk_bytes) {
+      throw std::exception();
+    }
+    components.push_back(component->second);
+    chunk_bytes.push_back(bytes);
+  }
+  // Each slot is either free or stored in a single row, a repeated one would leave two
+  // records (or a record and a free handle) for the same entity
+  std::vector<bool> seen(header.last_entity + 1, false);
+  auto claim = [&] (EntityId entity) {
+    uint32_t slot { entity_slot(entity) };
+    if (slot == 0 || slot > header.last_entity || seen[slot])
+      throw std::exception();
+    seen[slot] = true;
+  };
+  std::span<const EntityId> free_entities { in.read<EntityId>(header.free_entities) };
+  for (EntityId entity: free_entities) {
+    claim(entity);
+  }
+
+  // Every section is checked against the mapping before the world is replaced, so a
+  // malformed file leaves the registry untouched
+  std::vector<SnapshotSection> sections;
+  std::set<ArchetypeSignature> signatures;
+  ArchetypeSignature sorted;
+  uint32_t max_slot { 0 };
+  uint32_t newest_generation { 0 };
+  for (uint64_t a = 0; a < header.archetypes; ++a) {
+    const SnapshotArchetype &entry { in.read<SnapshotArchetype>() };
+    SnapshotSection &section { sections.emplace_back() };
+    std::span<const uint64_t> positions { in.read<uint64_t>(entry.components) };
+    section.entities = in.read<EntityId>(entry.rows);
+    in.align(snapshot_alignment);
+    if (section.entities.empty()) {
+      throw std::exception();
+    }
+    for (uint64_t position: positions) {
+      if (position >= components.size())
+        throw std::exception();
+      section.signature.push_back(components[position]);
+    }
+    sorted = section.signature;
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end() || !signatures.insert(sorted).second) {
+      throw std::exception();
+    }
+    for (EntityId entity: section.entities) {
+      claim(entity);
+      max_slot = std::max(max_slot, entity_slot(entity));
+      newest_generation = std::max(newest_generation, entity_generation(entity));
+    }
+    std::size_t chunks { (section.entities.size() + Column::chunk_rows - 1) / Column::chunk_rows };
+    for (uint64_t position: positions) {
+      if (chunks > SIZE_MAX / chunk_bytes[position])
+        throw std::exception();
+      section.images.push_back(in.read<uint8_t>(chunks * chunk_bytes[position]).data());
+    }
+  }
+
+  reset();
+  entity_index.resize(max_slot + 1);
+  std::vector<const uint8_t*> images;
+  for (SnapshotSection &section: sections) {
+    archetype_t archetype { register_archetype(section.signature) };
+    images.assign(section.images.size(), nullptr);
+    for (std::size_t i = 0; i < section.images.size(); ++i) {
+      images[archetype->column_value(section.signature[i])] = section.images[i];
+    }
+    archetype->load_rows(section.entities, images);
+    for (std::size_t row = 0; row < section.entities.size(); ++row) {
+      set_record(section.entities[row], archetype, row);
+    }
+  }
+  ids.restore_entities(header.last_entity, std::vector<EntityId>(free_entities.begin(), free_entities.end()),
+                       newest_generation);
+}
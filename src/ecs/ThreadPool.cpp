@@ -0,0 +1,102 @@
+#include "ThreadPool.hpp"
+
+namespace {
+/*! @brief Index of the current thread in its pool */
+thread_local std::size_t thread_index { 0 };
+}
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  std::size_t amount { threads > 1 ? threads : 1 };
+  for (std::size_t i = 0; i < amount; ++i) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (std::size_t i = 1; i < amount; ++i) {
+    workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock { sleep_mutex };
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &worker: workers) {
+    worker.join();
+  }
+}
+
+std::size_t ThreadPool::current_thread() {
+  return thread_index;
+}
+
+void ThreadPool::run(TaskGroup &group, Task task) {
+  group.pending.fetch_add(1, std::memory_order_relaxed);
+  if (workers.empty()) {
+    task();
+    group.pending.fetch_sub(1, std::memory_order_release);
+    return;
+  }
+  Task counted { [&group, task = std::move(task)] {
+    task();
+    group.pending.fetch_sub(1, std::memory_order_release);
+  } };
+  std::size_t index { thread_index < queues.size() ? thread_index : 0 };
+  {
+    std::lock_guard<std::mutex> lock { queues[index]->mutex };
+    queues[index]->tasks.push_back(std::move(counted));
+  }
+  {
+    std::lock_guard<std::mutex> lock { sleep_mutex };
+    queued.fetch_add(1, std::memory_order_release);
+  }
+  wake.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup &group) {
+  while (group.pending.load(std::memory_order_acquire) != 0) {
+    if (!try_run_one(thread_index < queues.size() ? thread_index : 0)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool ThreadPool::try_run_one(std::size_t index) {
+  Task task;
+  {
+    Queue &own { *queues[index] };
+    std::lock_guard<std::mutex> lock { own.mutex };
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (std::size_t i = 1; !task && i < queues.size(); ++i) {
+    Queue &victim { *queues[(index + i) % queues.size()] };
+    std::lock_guard<std::mutex> lock { victim.mutex };
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  queued.fetch_sub(1, std::memory_order_relaxed);
+  task();
+  return true;
+}
+
+void ThreadPool::work(std::size_t index) {
+  thread_index = index;
+  while (true) {
+    if (try_run_one(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock { sleep_mutex };
+    wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) != 0; });
+    if (stopping) {
+      return;
+    }
+  }
+}
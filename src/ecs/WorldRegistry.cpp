@@ -3,23 +3,94 @@
 #include "Types.hpp"
 #include <algorithm>
 
-WorldRegistry::WorldRegistry(uint64_t cycle_reset)
-    : entity_index(), system_index(), archetype_index(), cycle_reset{cycle_reset}
-{}
+WorldRegistry::WorldRegistry(uint64_t cycle_reset, std::size_t threads, std::pmr::memory_resource *upstream)
+    : graph_arena{upstream}, chunk_pool{upstream}, index_pool{upstream}, pool{threads}, cycle_reset{cycle_reset}
+{
+  for (std::size_t i = 0; i < pool.size(); ++i) {
+    command_buffers.push_back(std::make_unique<CommandBuffer>(ids));
+  }
+}
+
+WorldRegistry::~WorldRegistry() {
+  for (archetype_t archetype: non_trivial_archetypes) {
+    archetype->abandon();
+  }
+}
+
+archetype_t WorldRegistry::make_archetype(ArchetypeId id, std::vector<ComponentId> type) {
+  std::pmr::polymorphic_allocator<Archetype> allocator { &graph_arena };
+  archetype_t archetype { allocator.new_object<Archetype>(id, std::move(type), &chunk_pool, &graph_arena,
+                                                                      &index_pool) };
+  if (id >= archetype_table.size()) {
+    archetype_table.resize(id + 1, nullptr);
+  }
+  archetype_table[id] = archetype;
+  return archetype;
+}
+
+void WorldRegistry::destroy_archetype(archetype_t archetype) {
+  archetype_table[archetype->get_id()] = nullptr;
+  std::erase(non_trivial_archetypes, archetype);
+  std::destroy_at(archetype);
+}
 
 void WorldRegistry::delete_entity(EntityId entity) {
-  std::shared_ptr<Record> record = entity_index[entity];
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
+    return;
+  }
   archetype_t archetype { record->archetype };
-  if (archetype->size() == 0) {
-    archetype_index.erase(archetype->get_id());
+  record->archetype = nullptr;
+  record->entity = 0;
+  ids.recycle_entity_id(entity);
+  remove_row(archetype, record->row);
+}
+
+void WorldRegistry::migrate_rows(archetype_t from, std::size_t row, std::size_t amount, archetype_t to) {
+  if (amount == 0 || from == to) {
+    return;
+  }
+  std::size_t first { to->assign_rows_from(*from, row, amount) };
+  for (std::size_t i = 0; i < amount; ++i) {
+    from->remove_dependent_type();
+    to->insert_dependent_type();
+    Record &record { entity_index[entity_slot(to->get_entity(first + i))] };
+    record.archetype = to;
+    record.row = first + i;
+  }
+  std::size_t moved { from->remove_rows(row, amount) };
+  for (std::size_t i = row; i < row + moved; ++i) {
+    entity_index[entity_slot(from->get_entity(i))].row = i;
+  }
+}
+
+archetype_t WorldRegistry::find_transition(archetype_t archetype, ComponentId component, bool add) {
+  ArchetypeEdge *edge { archetype->find_edge(component) };
+  Archetype *cached { edge == nullptr ? nullptr : (add ? edge->add : edge->remove) };
+  if (cached != nullptr) {
+    return cached;
   }
-  entity_index.erase(entity);
-  std::size_t row = record->row;
-  ArchetypeSignature signature = archetype->get_type();
-  for (ComponentId component_id: signature) {
-    std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[component_id] };
-    ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-    (*archetype)[a_record].delete_component(record->row);
+  std::vector<ComponentId> new_signature = archetype->get_type();
+  if (add) {
+    new_signature.push_back(component);
+  } else {
+    new_signature.erase(std::find(new_signature.begin(), new_signature.end(), component));
+  }
+  archetype_t target { register_archetype(new_signature) };
+  if (add) {
+    archetype->get_edge(component).add = target;
+    target->get_edge(component).remove = archetype;
+  } else {
+    archetype->get_edge(component).remove = target;
+    target->get_edge(component).add = archetype;
+  }
+  return target;
+}
+
+void WorldRegistry::remove_row(archetype_t archetype, std::size_t row) {
+  EntityId moved { archetype->remove_row(row) };
+  if (moved != 0) {
+    entity_index[entity_slot(moved)].row = row;
   }
 }
 
@@ -27,15 +98,308 @@ void WorldRegistry::disable_system(const SystemId system) {
   disabled_systems_index.insert(system);
 }
 
+void WorldRegistry::enable_system(const SystemId system) {
+  disabled_systems_index.erase(system);
+}
+
+MemoryStats WorldRegistry::memory_stats() {
+  MemoryStats stats;
+  std::map<ComponentId, ComponentMemory> components;
+  auto account = [&] (Archetype &archetype) {
+    ArchetypeMemory memory { archetype.get_id(), archetype.size(), 0, 0, archetype.overhead_bytes(), {} };
+    const ArchetypeSignature &type { archetype.get_type() };
+    for (std::size_t i = 0; i < type.size(); ++i) {
+      Column &column { archetype[i] };
+      ColumnMemory column_memory { type[i], column.reserved_bytes(), column.used_bytes() };
+      memory.columns.push_back(column_memory);
+      memory.reserved += column_memory.reserved;
+      memory.used += column_memory.used;
+      auto [entry, inserted] = components.try_emplace(type[i], ComponentMemory { type[i], 0, 0, 0 });
+      ++entry->second.archetypes;
+      entry->second.reserved += column_memory.reserved;
+      entry->second.used += column_memory.used;
+    }
+    stats.archetypes.push_back(std::move(memory));
+  };
+  account(*root);
+  for (archetype_t archetype: registered_archetypes) {
+    account(*archetype);
+  }
+  std::sort(stats.archetypes.begin(), stats.archetypes.end(), [] (const ArchetypeMemory &a, const ArchetypeMemory &b) {
+    return a.id < b.id;
+  });
+  for (auto &[component, memory]: components) {
+    stats.components.push_back(memory);
+  }
+
+  std::size_t mapping_bytes { hash_map_bytes(component_archetype_mapping) };
+  for (auto &[component, mapping]: component_archetype_mapping) {
+    mapping_bytes += hash_map_bytes(mapping);
+  }
+  std::size_t signature_bytes { hash_map_bytes(signature_index) };
+  for (auto &[signature, archetype]: signature_index) {
+    signature_bytes += vector_bytes(signature);
+  }
+  std::size_t schedule_bytes { vector_bytes(schedule) };
+  for (auto &stage: schedule) {
+    schedule_bytes += vector_bytes(stage);
+  }
+  std::size_t command_bytes { vector_bytes(command_buffers) };
+  for (auto &buffer: command_buffers) {
+    command_bytes += sizeof(CommandBuffer) + buffer->memory_bytes();
+  }
+  stats.indices = {
+    IndexMemory { "entity_index", vector_bytes(entity_index) },
+    IndexMemory { "free entity ids", ids.free_list_bytes() },
+    IndexMemory { "archetype_table", vector_bytes(archetype_table) },
+    IndexMemory { "registered_archetypes", vector_bytes(registered_archetypes) },
+    IndexMemory { "signature_index", signature_bytes },
+    IndexMemory { "component_archetype_mapping", mapping_bytes },
+    IndexMemory { "component_info_index", hash_map_bytes(component_info_index) },
+    IndexMemory { "depth_index", hash_map_bytes(depth_index) },
+    IndexMemory { "system_index", tree_map_bytes(system_index) },
+    IndexMemory { "schedule", schedule_bytes },
+    IndexMemory { "disabled_systems_index", hash_map_bytes(disabled_systems_index) },
+    IndexMemory { "command buffers", command_bytes },
+    IndexMemory { "chunk pool free blocks", chunk_pool.free_bytes() },
+  };
+  return stats;
+}
+
+void WorldRegistry::set_system_label(const SystemId system, std::string label) {
+  system_index.at(system)->set_label(label);
+#ifdef ECS_PROFILING
+  profiler.set_label(system, std::move(label));
+#endif
+}
+
 void WorldRegistry::tick() {
-  for (auto system: system_index) {
-    system.second->run();
-    if (cycle == cycle_reset)
-      cycle = 0;
-    ++cycle;
+  if (schedule_dirty) {
+    build_schedule();
+  }
+#ifdef ECS_PROFILING
+  uint64_t tick_number { profiler.begin_tick() };
+  int64_t tick_start { profiler.now() };
+  auto run = [this, tick_number] (SystemBase *system) {
+    int64_t start { profiler.now() };
+    system->run();
+    profiler.record(system->get_id(), SystemSample { tick_number, start, profiler.now() - start,
+        system->entity_count(), system->archetype_count(), ThreadPool::current_thread() });
+  };
+#else
+  auto run = [] (SystemBase *system) { system->run(); };
+#endif
+  std::vector<SystemBase*> due;
+  for (std::vector<SystemBase*> &stage: schedule) {
+    due.clear();
+    for (SystemBase *system: stage) {
+      if (system->runs_in(cycle) && !disabled_systems_index.contains(system->get_id()))
+        due.push_back(system);
+    }
+    if (due.size() == 1) {
+      run(due[0]);
+      continue;
+    }
+    ThreadPool::TaskGroup group;
+    for (SystemBase *system: due) {
+      pool.run(group, [&run, system] { run(system); });
+    }
+    pool.wait(group);
+  }
+  flush_commands();
+#ifdef ECS_PROFILING
+  profiler.end_tick(tick_start);
+#endif
+  ++cycle;
+  if (cycle == cycle_reset)
+    cycle = 0;
+}
+
+void WorldRegistry::flush_commands() {
+  struct Pending {
+    EntityId entity;
+    archetype_t source;
+    archetype_t target;
+    bool despawn;
+    std::vector<std::pair<ComponentId, void*>> values;
+  };
+  struct Spawn {
+    archetype_t archetype;
+    CommandBuffer *buffer;
+    const Command *command;
+  };
+  struct Segment {
+    CommandOrigin origin;
+    CommandBuffer *buffer;
+    std::size_t first;
+    std::size_t last;
+  };
+  std::vector<Segment> segments;
+  for (auto &buffer: command_buffers) {
+    const std::vector<CommandRun> &runs { buffer->get_runs() };
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+      std::size_t last { i + 1 < runs.size() ? runs[i + 1].first : buffer->get_commands().size() };
+      segments.push_back(Segment { runs[i].origin, buffer.get(), runs[i].first, last });
+    }
+  }
+  std::stable_sort(segments.begin(), segments.end(), [] (const Segment &a, const Segment &b) {
+    return a.origin < b.origin;
+  });
+
+  std::vector<Pending> pending;
+  std::unordered_map<EntityId, std::size_t> pending_index;
+  std::vector<Spawn> spawns;
+  for (const Segment &segment: segments) {
+    CommandBuffer *buffer { segment.buffer };
+    for (std::size_t i = segment.first; i < segment.last; ++i) {
+      const Command &command { buffer->get_commands()[i] };
+      if (command.type == CommandType::spawn) {
+        std::vector<ComponentId> signature;
+        const SpawnComponent *components { buffer->get_spawn_components(command) };
+        for (std::size_t i = 0; i < command.amount; ++i) {
+          signature.push_back(components[i].component);
+        }
+        spawns.push_back(Spawn { register_archetype(signature), buffer, &command });
+        continue;
+      }
+      Record *record { find_record(command.entity) };
+      if (record == nullptr) {
+        continue;
+      }
+      auto [index, inserted] = pending_index.try_emplace(command.entity, pending.size());
+      if (inserted) {
+        pending.push_back(Pending { command.entity, record->archetype, record->archetype, false, {} });
+      }
+      Pending &entry { pending[index->second] };
+      if (entry.despawn) {
+        continue;
+      }
+      switch (command.type) {
+        case CommandType::despawn:
+          entry.despawn = true;
+          break;
+        case CommandType::add:
+          if (!entry.target->get_mask().test(command.component))
+            entry.target = find_transition(entry.target, command.component, true);
+          entry.values.emplace_back(command.component, buffer->get_data(command.offset));
+          break;
+        case CommandType::remove:
+          if (entry.target->get_mask().test(command.component))
+            entry.target = find_transition(entry.target, command.component, false);
+          break;
+        case CommandType::set:
+          entry.values.emplace_back(command.component, buffer->get_data(command.offset));
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  std::sort(pending.begin(), pending.end(), [] (const Pending &a, const Pending &b) {
+    return std::make_tuple(a.source->get_id(), a.despawn, a.target->get_id(), entity_slot(a.entity))
+         < std::make_tuple(b.source->get_id(), b.despawn, b.target->get_id(), entity_slot(b.entity));
+  });
+  std::vector<EntityId> group;
+  for (std::size_t first = 0; first < pending.size();) {
+    std::size_t last { first };
+    group.clear();
+    while (last < pending.size() && pending[last].source == pending[first].source
+        && pending[last].despawn == pending[first].despawn && pending[last].target == pending[first].target) {
+      group.push_back(pending[last].entity);
+      ++last;
+    }
+    if (pending[first].despawn) {
+      std::sort(group.begin(), group.end(), [&] (EntityId a, EntityId b) {
+        return find_record(a)->row > find_record(b)->row;
+      });
+      for (EntityId entity: group) {
+        delete_entity(entity);
+      }
+    } else if (pending[first].source != pending[first].target) {
+      move_entities(pending[first].source, pending[first].target, group);
+    }
+    first = last;
+  }
+  for (Pending &entry: pending) {
+    Record *record { find_record(entry.entity) };
+    if (record == nullptr) {
+      continue;
+    }
+    for (auto [component, value]: entry.values) {
+      if (record->archetype->get_mask().test(component))
+        get_column(record->archetype, component).move_in(value, record->row);
+    }
+  }
+
+  std::stable_sort(spawns.begin(), spawns.end(), [] (const Spawn &a, const Spawn &b) {
+    return a.archetype->get_id() < b.archetype->get_id();
+  });
+  for (std::size_t first = 0; first < spawns.size();) {
+    std::size_t last { first };
+    while (last < spawns.size() && spawns[last].archetype == spawns[first].archetype) {
+      ++last;
+    }
+    archetype_t archetype { spawns[first].archetype };
+    std::vector<EntityId> new_entities(last - first);
+    for (EntityId &entity: new_entities) {
+      entity = ids.gen_entity_id();
+    }
+    std::size_t row { archetype->assign_rows(new_entities) };
+    for (std::size_t i = first; i < last; ++i, ++row) {
+      set_record(new_entities[i - first], archetype, row);
+      const Command &command { *spawns[i].command };
+      const SpawnComponent *components { spawns[i].buffer->get_spawn_components(command) };
+      for (std::size_t j = 0; j < command.amount; ++j) {
+        void *value { spawns[i].buffer->get_data(components[j].offset) };
+        get_column(archetype, components[j].component).move_in(value, row);
+      }
+    }
+    first = last;
+  }
+
+  for (auto &buffer: command_buffers) {
+    buffer->clear();
+  }
+}
+
+void WorldRegistry::move_entities(archetype_t from, archetype_t to, const std::vector<EntityId> &entities) {
+  std::vector<std::size_t> rows;
+  rows.reserve(entities.size());
+  for (EntityId entity: entities) {
+    rows.push_back(find_record(entity)->row);
+  }
+  std::sort(rows.begin(), rows.end(), std::greater<std::size_t>());
+  for (std::size_t last = 0; last < rows.size();) {
+    std::size_t first { last };
+    while (last + 1 < rows.size() && rows[last + 1] + 1 == rows[last]) {
+      ++last;
+    }
+    migrate_rows(from, rows[last], last - first + 1, to);
+    ++last;
   }
 }
 
+void WorldRegistry::build_schedule() {
+  std::unordered_map<SystemId, std::size_t> stage_of;
+  schedule.clear();
+  for (auto [system_id, system]: system_index) {
+    std::size_t stage { 0 };
+    for (SystemId conflict: system->get_conflicts()) {
+      auto conflict_stage = stage_of.find(conflict);
+      if (conflict_stage != stage_of.end()) {
+        stage = std::max(stage, conflict_stage->second + 1);
+      }
+    }
+    stage_of[system_id] = stage;
+    if (stage == schedule.size()) {
+      schedule.emplace_back();
+    }
+    schedule[stage].push_back(system);
+  }
+  schedule_dirty = false;
+}
+
 std::size_t WorldRegistry::count_components() {
   return ids.get_component_amount();
 }
@@ -47,33 +411,24 @@ archetype_t WorldRegistry::add_node(archetype_t archetype) {
 archetype_t WorldRegistry::add_node(std::vector<ComponentId> type) {
   std::vector<ComponentId> &signature = type;
   std::vector<ComponentId> new_signature;
-  archetype_t last = root;
-  ComponentId last_component = signature[0];
-  archetype_t it = root;
+  Archetype *it = root;
   std::size_t depth = 0;
   for (ComponentId component: signature) {
     new_signature.push_back(component);
-    std::map<ComponentId, std::shared_ptr<ArchetypeEdge>> &edges = it->get_edges();
-    if (!edges.contains(component)) {
-      std::shared_ptr<ArchetypeEdge> new_edge ( new ArchetypeEdge() );
+    if (it->find_edge(component) == nullptr) {
       std::tuple<ComponentId, std::size_t> component_depth = std::make_tuple(component, depth);
       std::tuple<archetype_t, std::size_t> indexed_tuple = depth_index[component_depth];
-      if (std::get<archetype_t>(indexed_tuple) == nullptr) {
-        archetype_t new_arch (new Archetype(ids.gen_archetype_id(), new_signature));
+      archetype_t new_arch = std::get<archetype_t>(indexed_tuple);
+      if (new_arch == nullptr) {
+        new_arch = make_archetype(ids.gen_archetype_id(), new_signature);
         depth_index[component_depth] = std::make_tuple(new_arch, 1);
-        new_edge->add = std::make_tuple(new_arch, component);
       } else {
-        auto new_arch = std::get<archetype_t>(indexed_tuple);
-        new_edge->add = std::make_tuple(new_arch, component);
-        auto new_entry = std::make_tuple(new_arch, std::get<std::size_t>(indexed_tuple) + 1);
-        depth_index[component_depth] = new_entry;
+        depth_index[component_depth] = std::make_tuple(new_arch, std::get<std::size_t>(indexed_tuple) + 1);
       }
-      new_edge->remove = std::make_tuple(last, last_component);
-      edges[component] = new_edge;
+      it->get_edge(component).add = new_arch;
+      new_arch->get_edge(component).remove = it;
     }
-    last_component = component;
-    last = it;
-    it = std::get<archetype_t>(edges.find(component)->second->add);
+    it = it->find_edge(component)->add;
     depth++;
   }
   return it;
@@ -81,77 +436,137 @@ archetype_t WorldRegistry::add_node(std::vector<ComponentId> type) {
 
 void WorldRegistry::list_each(archetype_t archetype, std::vector<ComponentId> &input,
     std::vector<Archetype*> &visited ) {
-  auto edges = archetype->get_edges();
-  for (auto edge: edges) {
-    archetype_t next_archetype = std::get<archetype_t>(edge.second->add);
-    ComponentId component_id = std::get<ComponentId>(edge.second->add);
-    if (std::find(visited.begin(), visited.end(), next_archetype.get()) != visited.end()) {
+  for (ArchetypeEdge &edge: archetype->get_edges()) {
+    Archetype *next_archetype = edge.add;
+    if (next_archetype == nullptr) {
+      continue;
+    }
+    if (std::find(visited.begin(), visited.end(), next_archetype) != visited.end()) {
       return;
     }
-    input.push_back(component_id);
-    visited.push_back(next_archetype.get());
-    list_each(std::get<archetype_t>(edge.second->add), input, visited);
+    input.push_back(edge.component);
+    visited.push_back(next_archetype);
+    list_each(next_archetype, input, visited);
   }
 }
 
 void WorldRegistry::create_archetype_columns(archetype_t archetype) {
+  bool trivial { true };
   for (ComponentId component: archetype->get_type()) {
-    archetype->create_column(component_size_index[component], component);
+    const ComponentInfo &info { component_info_index.at(component) };
+    archetype->create_column(info, component);
+    trivial = trivial && info.trivially_relocatable;
+  }
+  if (!trivial) {
+    non_trivial_archetypes.push_back(archetype);
   }
 }
 
 void WorldRegistry::create_component_archetype_mapping(archetype_t archetype) {
   for (ComponentId component_id: archetype->get_type()) {
-    ArchetypeRecord new_record { archetype->column_value(component_id)};
-    if (component_archetype_mapping[component_id] == nullptr) {
-      std::shared_ptr<ArchetypeMap> archetype_mapping { new ArchetypeMap {} };
-      (*archetype_mapping)[archetype->get_id()] = new_record;
-      component_archetype_mapping[component_id] = archetype_mapping;
-    } else {
-      std::shared_ptr<ArchetypeMap> old_map = component_archetype_mapping[component_id];
-      (*old_map)[archetype->get_id()] = new_record;
-    }
+    component_archetype_mapping[component_id][archetype->get_id()] = archetype->column_value(component_id);
   }
 }
 
 void WorldRegistry::attach_component(EntityId entity, ComponentId component_id, void *component) {
-  std::shared_ptr<Record> record { entity_index[entity] };
+  Record *record { find_record(entity) };
   if (record == nullptr) {
     return;
   }
-  archetype_t archetype { record->archetype };
-  std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[component_id] };
-  if (archetype_map == nullptr) {
+  Column *column { record->archetype->find_column(component_id) };
+  if (column == nullptr) {
     return;
   }
-  ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-  (*archetype)[a_record].insert(component, record->row);
+  column->insert(component, record->row);
 }
 
 void *WorldRegistry::get_component(EntityId entity, ComponentId component_id) {
-  if (entity_index[entity] == nullptr) {
+  Record *record { find_record(entity) };
+  if (record == nullptr) {
     return nullptr;
   }
-  std::shared_ptr<Record> record { entity_index[entity] };
-  archetype_t archetype { record->archetype };
-  std::shared_ptr<ArchetypeMap> archetype_map { component_archetype_mapping[component_id] };
-  if (archetype_map->count(archetype->get_id()) == 0) {
+  Column *column { record->archetype->find_column(component_id) };
+  if (column == nullptr || column->is_split()) {
     return nullptr;
   }
-  ArchetypeRecord a_record { (*archetype_map)[archetype->get_id()] };
-  return (*archetype)[a_record].get(record->row);
+  return column->get(record->row);
 }
 
 archetype_t WorldRegistry::register_archetype(std::vector<ComponentId> &components) {
-  ArchetypeId arch_id = ids.gen_archetype_id();
-  //archetype_ids.put<T...>(arch_id);
-  archetype_t new_archetype { new Archetype(arch_id, components) };
-  archetype_index[arch_id] = new_archetype;
-  for (auto system: system_index) {
-    system.second->add_archetype(new_archetype);
+  ArchetypeSignature signature { components };
+  std::sort(signature.begin(), signature.end());
+  signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+  auto registered = signature_index.find(signature);
+  if (registered != signature_index.end()) {
+    return registered->second;
   }
+  ArchetypeId arch_id = ids.gen_archetype_id();
+  archetype_t new_archetype { make_archetype(arch_id, signature) };
+  registered_archetypes.push_back(new_archetype);
+  signature_index[signature] = new_archetype;
   add_node(new_archetype);
   create_component_archetype_mapping(new_archetype);
   create_archetype_columns(new_archetype);
+  for (auto system: system_index) {
+    system.second->add_archetype(new_archetype);
+  }
   return new_archetype;
 }
+
+void WorldRegistry::reset() {
+  for (auto &buffer: command_buffers) {
+    buffer->clear();
+  }
+  for (auto &[system_id, system]: system_index) {
+    system->clear_archetypes();
+  }
+  // Only the components with destructors are visited, every chunk and table goes back
+  // with the resources
+  for (archetype_t archetype: non_trivial_archetypes) {
+    archetype->abandon();
+  }
+  entity_index = std::pmr::vector<Record> { &index_pool };
+  archetype_table = std::pmr::vector<archetype_t> { &index_pool };
+  registered_archetypes = std::pmr::vector<archetype_t> { &index_pool };
+  non_trivial_archetypes = std::pmr::vector<archetype_t> { &index_pool };
+  signature_index = decltype(signature_index) { &index_pool };
+  depth_index = decltype(depth_index) { &index_pool };
+  component_archetype_mapping = decltype(component_archetype_mapping) { &index_pool };
+  chunk_pool.release();
+  graph_arena.release();
+  index_pool.release();
+  archetype_ids.clear();
+  ids.reset_entities();
+  ids.reset_archetypes();
+  root = make_archetype(0, std::vector<ComponentId>());
+}
+
+std::size_t WorldRegistry::prune_empty_archetypes() {
+  std::vector<archetype_t> dead;
+  for (archetype_t archetype: registered_archetypes) {
+    if (archetype->size() == 0)
+      dead.push_back(archetype);
+  }
+  for (archetype_t archetype: dead) {
+    ArchetypeId archetype_id { archetype->get_id() };
+    for (auto system: system_index) {
+      system.second->remove_archetype(archetype);
+    }
+    for (ComponentId component: archetype->get_type()) {
+      component_archetype_mapping[component].erase(archetype_id);
+    }
+    for (ArchetypeEdge &edge: archetype->get_edges()) {
+      if (edge.add != nullptr)
+        edge.add->get_edge(edge.component).remove = nullptr;
+      if (edge.remove != nullptr)
+        edge.remove->get_edge(edge.component).add = nullptr;
+    }
+    signature_index.erase(archetype->get_type());
+    archetype_ids.remove_value(archetype_id);
+  }
+  std::erase_if(registered_archetypes, [] (archetype_t archetype) { return archetype->size() == 0; });
+  for (archetype_t archetype: dead) {
+    destroy_archetype(archetype);
+  }
+  return dead.size();
+}
@@ -20,10 +20,9 @@ int main() {
     s.y += v.y;
   };
   //registry.register_system<Velocity, Speed>(speed_system);
-  for (int i = 0; i < 100000; ++i) {
-    EntityId entity = registry.create_entity<Velocity, Speed>();
-    registry.attach_component(entity, (Velocity){10 * i, 2 * i});
-    registry.attach_component(entity, (Speed){5 * i, 3 * i, i});
-  }
+  registry.create_entities<Velocity, Speed>(100000, [] (std::size_t i) {
+    int n = static_cast<int>(i);
+    return std::make_tuple((Velocity){10 * n, 2 * n}, (Speed){5 * n, 3 * n, n});
+  });
   return 0;
 }
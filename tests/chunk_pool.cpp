@@ -0,0 +1,146 @@
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "ChunkPool.hpp"
+#include "WorldRegistry.hpp"
+
+/*! @brief Upstream resource that counts the bytes it hands out */
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocated { 0 };
+  std::size_t live { 0 };
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    allocated += bytes;
+    live += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override {
+    live -= bytes;
+    std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+struct Heat {
+  float value;
+};
+
+struct Label {
+  std::string text;
+};
+
+TEST_CASE("Chunk pool reuses freed blocks", "[chunk_pool]") {
+  CountingResource upstream;
+  {
+    ChunkPool pool { &upstream };
+    void *first = pool.allocate(4096, 64);
+    void *second = pool.allocate(4096, 64);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(first) % 64 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(second) % 64 == 0);
+    REQUIRE(first != second);
+    REQUIRE(upstream.allocated == ChunkPool::slab_bytes);
+    pool.deallocate(first, 4096, 64);
+    REQUIRE(pool.allocate(4096, 64) == first);
+    REQUIRE(pool.free_bytes() == ChunkPool::slab_bytes - 2 * 4096);
+
+    void *large = pool.allocate(2 * ChunkPool::slab_bytes, 128);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(large) % 128 == 0);
+    REQUIRE(pool.reserved_bytes() == 3 * ChunkPool::slab_bytes);
+    pool.release();
+    REQUIRE(upstream.live == 0);
+    REQUIRE(pool.reserved_bytes() == 0);
+    REQUIRE(pool.allocate(4096, 64) != nullptr);
+  }
+  REQUIRE(upstream.live == 0);
+}
+
+TEST_CASE("Registry allocates from the upstream resource and resets", "[registry_reset]") {
+  CountingResource upstream;
+  {
+    WorldRegistry registry { 10, 1, &upstream };
+    registry.register_component<Heat>();
+    registry.register_component<Label>();
+    int runs = 0;
+    registry.register_system<Heat>([&] (Heat &heat) { heat.value += 1.0f; ++runs; });
+    registry.create_entities<Heat>(3 * Column::chunk_rows);
+    EntityId labelled = registry.create_entity<Heat, Label>();
+    registry.attach_component(labelled, Label { "a label that does not fit in the small buffer" });
+    REQUIRE(upstream.live > 3 * Column::chunk_rows * sizeof(Heat));
+
+    registry.reset();
+    std::size_t after_reset = upstream.live;
+    REQUIRE(after_reset < 3 * Column::chunk_rows * sizeof(Heat));
+    REQUIRE(registry.memory_stats().used() == 0);
+    registry.tick();
+    REQUIRE(runs == 0);
+    REQUIRE(!registry.get_component<Heat>(labelled).has_value());
+
+    std::size_t before = upstream.allocated;
+    EntityId entity = registry.create_entity<Heat>();
+    registry.attach_component(entity, Heat { 1.0f });
+    registry.tick();
+    REQUIRE(runs == 1);
+    REQUIRE(registry.get_component<Heat>(entity).value().value == 2.0f);
+    REQUIRE(upstream.allocated > before);
+
+    for (int i = 0; i < 3; ++i) {
+      registry.reset();
+      REQUIRE(upstream.live == after_reset);
+      registry.create_entities<Heat>(Column::chunk_rows);
+      REQUIRE(registry.memory_stats().reserved() == Column::chunk_rows * sizeof(Heat));
+    }
+  }
+  REQUIRE(upstream.live == 0);
+}
+
+TEST_CASE("Handles taken before a reset stay stale", "[registry_reset]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Heat>();
+  EntityId before = registry.create_entity<Heat>();
+  EntityId deleted = registry.create_entity<Heat>();
+  registry.delete_entity(deleted);
+  registry.create_entity<Heat>();
+  registry.reset();
+  EntityId after = registry.create_entity<Heat>();
+  registry.attach_component(after, Heat { 42.0f });
+  EntityId second = registry.create_entity<Heat>();
+  REQUIRE(entity_slot(after) == entity_slot(before));
+  REQUIRE(after != before);
+  REQUIRE(second != deleted);
+  REQUIRE(!registry.get_component<Heat>(before).has_value());
+  REQUIRE(registry.try_get<Heat>(before) == nullptr);
+  REQUIRE(registry.get_component<Heat>(after).value().value == 42.0f);
+}
+
+struct Lease {
+  std::shared_ptr<int> owner;
+};
+
+TEST_CASE("Reset and destruction run the destructors of non trivial components", "[registry_reset]") {
+  std::shared_ptr<int> owner = std::make_shared<int>(0);
+  {
+    WorldRegistry registry { 10, 1 };
+    registry.register_component<Heat>();
+    registry.register_component<Lease>();
+    registry.create_entities<Heat>(2 * Column::chunk_rows);
+    for (int i = 0; i < 3; ++i) {
+      EntityId entity = registry.create_entity<Heat, Lease>();
+      registry.attach_component(entity, Lease { owner });
+    }
+    REQUIRE(owner.use_count() == 4);
+    registry.reset();
+    REQUIRE(owner.use_count() == 1);
+
+    EntityId entity = registry.create_entity<Lease>();
+    registry.attach_component(entity, Lease { owner });
+    REQUIRE(owner.use_count() == 2);
+  }
+  REQUIRE(owner.use_count() == 1);
+}
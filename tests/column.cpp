@@ -0,0 +1,135 @@
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "Column.hpp"
+
+struct Position {
+  int x;
+  int y;
+};
+
+TEST_CASE("Column grows past a single chunk", "[column_growth]") {
+  Column column { sizeof(Position), 1 };
+  const std::size_t rows = 3 * Column::chunk_rows + 7;
+  for (std::size_t i = 0; i < rows; ++i) {
+    std::size_t row = column.push_back();
+    column.insert((Position){(int) i, (int) (2 * i)}, row);
+  }
+  REQUIRE(column.size() == rows);
+  REQUIRE(column.chunk_count() == 4);
+  REQUIRE(column.chunk_size(3) == 7);
+  REQUIRE(column.get<Position>(0).x == 0);
+  REQUIRE(column.get<Position>(Column::chunk_rows).y == 2 * Column::chunk_rows);
+  REQUIRE(column.get<Position>(rows - 1).x == (int) (rows - 1));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(column.get_vector<Position>(2).first) % Column::chunk_alignment == 0);
+}
+
+TEST_CASE("Column releases empty chunks", "[column_release]") {
+  Column column { sizeof(Position), 1 };
+  for (std::size_t i = 0; i < Column::chunk_rows + 1; ++i) {
+    column.push_back();
+  }
+  REQUIRE(column.chunk_count() == 2);
+  column.pop_back();
+  REQUIRE(column.chunk_count() == 1);
+  REQUIRE(column.chunk_size(0) == Column::chunk_rows);
+}
+
+struct Tracked {
+  static inline int alive = 0;
+  static inline int defaulted = 0;
+  std::string name { "tracked" };
+  Tracked() { ++alive; ++defaulted; }
+  Tracked(const Tracked &other) : name{other.name} { ++alive; }
+  Tracked(Tracked &&other) noexcept : name{std::move(other.name)} { ++alive; }
+  Tracked &operator=(const Tracked &) = default;
+  Tracked &operator=(Tracked &&) noexcept = default;
+  ~Tracked() { --alive; }
+};
+
+TEST_CASE("Column runs the lifecycle of non trivial components", "[column_lifecycle]") {
+  {
+    Column column { ComponentInfo::of<Tracked>(), 1 };
+    REQUIRE_FALSE(column.get_info().trivially_relocatable);
+    column.push_back(Column::chunk_rows + 2);
+    REQUIRE(Tracked::alive == (int) Column::chunk_rows + 2);
+    REQUIRE(static_cast<Tracked*>(column.get(Column::chunk_rows))->name == "tracked");
+    static_cast<Tracked*>(column.get(Column::chunk_rows + 1))->name = "a component name past the small buffer";
+    column.delete_component(0);
+    REQUIRE(static_cast<Tracked*>(column.get(0))->name == "a component name past the small buffer");
+    REQUIRE(Tracked::alive == (int) Column::chunk_rows + 1);
+    column.delete_components(1, 10);
+    REQUIRE(Tracked::alive == (int) Column::chunk_rows - 9);
+    Column moved { std::move(column) };
+    REQUIRE(moved.size() == Column::chunk_rows - 9);
+    REQUIRE(Tracked::alive == (int) Column::chunk_rows - 9);
+  }
+  REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("Column moves appended rows into raw memory", "[column_lifecycle]") {
+  {
+    Column source { ComponentInfo::of<Tracked>(), 1 };
+    Column target { ComponentInfo::of<Tracked>(), 1 };
+    source.push_back(3);
+    static_cast<Tracked*>(source.get(2))->name = "moved without a default construction first";
+    int defaulted = Tracked::defaulted;
+    REQUIRE(target.append(source, 1, 2) == 0);
+    REQUIRE(Tracked::defaulted == defaulted);
+    REQUIRE(Tracked::alive == 5);
+    REQUIRE(static_cast<Tracked*>(target.get(1))->name == "moved without a default construction first");
+    REQUIRE(static_cast<Tracked*>(target.get(0))->name == "tracked");
+  }
+  REQUIRE(Tracked::alive == 0);
+}
+
+struct Body {
+  float x;
+  float y;
+  float vx;
+  float vy;
+  int id;
+};
+
+ECS_SPLIT_COMPONENT(Body, &Body::x, &Body::y, &Body::vx, &Body::vy)
+
+TEST_CASE("Split columns store each field in its own array", "[column_split]") {
+  Column column { ComponentInfo::of<Body>(), 1 };
+  REQUIRE(column.is_split());
+  const std::size_t rows = Column::chunk_rows + 5;
+  column.push_back(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    column.insert((Body){(float) i, 1.0f, 2.0f, -(float) i, 7}, i);
+  }
+  REQUIRE(column.get<Body>(3).x == 3.0f);
+  REQUIRE(column.get<Body>(3).vy == -3.0f);
+  REQUIRE(column.get<Body>(3).id == 0);
+  float *xs = reinterpret_cast<float*>(column.field_data(1, 0));
+  REQUIRE(xs[4] == (float) (Column::chunk_rows + 4));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(column.field_data(0, 2)) % Column::chunk_alignment == 0);
+  REQUIRE(*static_cast<float*>(column.get(Column::chunk_rows + 4)) == (float) (Column::chunk_rows + 4));
+
+  FieldSpans<Body> spans = make_chunk_span<Body>(column, 1);
+  REQUIRE(spans.size() == 5);
+  REQUIRE(spans.get<&Body::vy>()[2] == -(float) (Column::chunk_rows + 2));
+  REQUIRE(spans.field<1>()[0] == 1.0f);
+  spans[0].get<&Body::y>() = 9.0f;
+  REQUIRE(column.get<Body>(Column::chunk_rows).y == 9.0f);
+
+  column.delete_component(0);
+  REQUIRE(column.get<Body>(0).x == (float) (rows - 1));
+  REQUIRE(column.get<Body>(0).vx == 2.0f);
+}
+
+struct alignas(128) Wide {
+  float lanes[32];
+};
+
+TEST_CASE("Column chunks honour the component alignment", "[column_alignment]") {
+  Column column { ComponentInfo::of<Wide>(), 1 };
+  REQUIRE(column.get_alignment() == 128);
+  column.push_back(Column::chunk_rows + 3);
+  for (std::size_t chunk = 0; chunk < column.chunk_count(); ++chunk) {
+    REQUIRE(reinterpret_cast<std::uintptr_t>(column.get_vector<Wide>(chunk).first) % 128 == 0);
+  }
+  REQUIRE(reinterpret_cast<std::uintptr_t>(column.get(Column::chunk_rows + 2)) % 128 == 0);
+}
@@ -0,0 +1,28 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ComponentMask.hpp"
+
+TEST_CASE("Component mask superset tests", "[component_mask]") {
+  ComponentMask archetype { std::vector<ComponentId>{1, 5, 70, 200} };
+  ComponentMask query { std::vector<ComponentId>{5, 200} };
+  ComponentMask other { std::vector<ComponentId>{5, 6} };
+  REQUIRE(archetype.contains(query));
+  REQUIRE(!archetype.contains(other));
+  REQUIRE(archetype.intersects(other));
+  REQUIRE(archetype.test(70));
+  REQUIRE(!archetype.test(71));
+  REQUIRE(!archetype.test(ComponentMask::capacity + 10));
+  REQUIRE(archetype.count() == 4);
+}
+
+TEST_CASE("Component mask hashing ignores insertion order", "[component_mask_hash]") {
+  ComponentMask first { std::vector<ComponentId>{3, 1, 130} };
+  ComponentMask second { std::vector<ComponentId>{130, 3, 1} };
+  ComponentMask third { std::vector<ComponentId>{130, 3} };
+  REQUIRE(first == second);
+  REQUIRE(std::hash<ComponentMask>{}(first) == std::hash<ComponentMask>{}(second));
+  REQUIRE(std::hash<ComponentMask>{}(first) != std::hash<ComponentMask>{}(third));
+  third.set(1);
+  REQUIRE(first == third);
+  third.reset(1);
+  REQUIRE(first != third);
+}
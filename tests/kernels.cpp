@@ -0,0 +1,26 @@
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "Kernels.hpp"
+
+TEST_CASE("Vectorized kernels match the scalar loop", "[kernels]") {
+  for (std::size_t amount: {0, 1, 7, 8, 17, 1000, 1023}) {
+    std::vector<float> x(amount), y(amount), expected(amount);
+    for (std::size_t i = 0; i < amount; ++i) {
+      x[i] = (float) i;
+      y[i] = (float) (amount - i);
+      expected[i] = y[i];
+    }
+    axpy(y.data(), x.data(), 0.5f, amount);
+    axpy_scalar(expected.data(), x.data(), 0.5f, amount);
+    REQUIRE(y == expected);
+
+    scale(y.data(), 2.0f, amount);
+    float sum = 0;
+    for (std::size_t i = 0; i < amount; ++i) {
+      REQUIRE(y[i] == 2.0f * expected[i]);
+      sum += x[i];
+    }
+    std::vector<float> ones(amount, 1.0f);
+    REQUIRE(dot(x.data(), ones.data(), amount) == sum);
+  }
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+#include "WorldRegistry.hpp"
+
+struct Transform {
+  float x;
+  float y;
+};
+
+struct Health {
+  int value;
+};
+
+TEST_CASE("Memory stats report reserved and used bytes", "[memory_stats]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Transform>();
+  registry.register_component<Health>();
+  registry.create_entities<Transform, Health>(Column::chunk_rows + 1);
+  registry.create_entities<Health>(10);
+  ComponentId transform = registry.get_component_id<Transform>();
+  ComponentId health = registry.get_component_id<Health>();
+
+  MemoryStats stats = registry.memory_stats();
+  const ArchetypeMemory *both = nullptr;
+  for (const ArchetypeMemory &archetype: stats.archetypes) {
+    if (archetype.columns.size() == 2)
+      both = &archetype;
+  }
+  REQUIRE(both != nullptr);
+  REQUIRE(both->entities == Column::chunk_rows + 1);
+  REQUIRE(both->used == (Column::chunk_rows + 1) * (sizeof(Transform) + sizeof(Health)));
+  REQUIRE(both->reserved == 2 * Column::chunk_rows * (sizeof(Transform) + sizeof(Health)));
+  REQUIRE(both->overhead > 0);
+
+  auto find = [&] (ComponentId component) {
+    return *std::find_if(stats.components.begin(), stats.components.end(), [&] (const ComponentMemory &memory) {
+      return memory.component == component;
+    });
+  };
+  REQUIRE(stats.components.size() == 2);
+  REQUIRE(find(health).archetypes == 2);
+  REQUIRE(find(health).used == (Column::chunk_rows + 11) * sizeof(Health));
+  REQUIRE(find(transform).archetypes == 1);
+  REQUIRE(stats.used() == (Column::chunk_rows + 1) * sizeof(Transform) + (Column::chunk_rows + 11) * sizeof(Health));
+  REQUIRE(stats.reserved() >= stats.used());
+  REQUIRE(stats.indices.front().name == "entity_index");
+  REQUIRE(stats.indices.front().bytes >= (Column::chunk_rows + 11) * sizeof(Record));
+
+  std::ostringstream dump;
+  stats.dump(dump, 1);
+  REQUIRE(dump.str().find("archetypes by wasted bytes") != std::string::npos);
+  REQUIRE(dump.str().find("entity_index") != std::string::npos);
+}
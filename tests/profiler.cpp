@@ -0,0 +1,64 @@
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+#include "Profiler.hpp"
+#include "WorldRegistry.hpp"
+
+TEST_CASE("Profiler keeps the last samples of each system", "[profiler]") {
+  Profiler profiler { 100 };
+  profiler.add_system(1);
+  profiler.add_system(2);
+  REQUIRE(profiler.get_label(1) == "system 1");
+  REQUIRE(profiler.get_timings(1) == std::nullopt);
+  for (int64_t i = 1; i <= 150; ++i) {
+    uint64_t tick = profiler.begin_tick();
+    profiler.record(1, SystemSample { tick, i * 1000, i, 10, 1, 0 });
+  }
+  std::vector<SystemSample> samples = profiler.get_samples(1);
+  REQUIRE(samples.size() == 100);
+  REQUIRE(samples.front().duration_ns == 51);
+  REQUIRE(samples.back().duration_ns == 150);
+  SystemTimings timings = profiler.get_timings(1).value();
+  REQUIRE(timings.samples == 100);
+  REQUIRE(timings.min_ns == 51);
+  REQUIRE(timings.max_ns == 150);
+  REQUIRE(timings.avg_ns == 100);
+  REQUIRE(timings.p99_ns == 149);
+
+  profiler.set_label(2, "physics \"integrator\"");
+  profiler.record(2, SystemSample { 150, 2500, 1500, 3, 2, 1 });
+  std::ostringstream trace;
+  profiler.export_chrome_trace(trace);
+  REQUIRE(trace.str().find("{\"name\":\"physics \\\"integrator\\\"\",\"cat\":\"system\",\"ph\":\"X\",\"pid\":0,\"tid\":1,"
+                           "\"ts\":2.500,\"dur\":1.500,\"args\":{\"tick\":150,\"entities\":3,\"archetypes\":2}}") != std::string::npos);
+
+  profiler.clear();
+  REQUIRE(profiler.get_samples(1).empty());
+  REQUIRE(profiler.get_label(2) == "physics \"integrator\"");
+}
+
+#ifdef ECS_PROFILING
+struct Mass {
+  float value;
+};
+
+TEST_CASE("Registry records the systems of every tick", "[profiler_registry]") {
+  WorldRegistry registry { 10, 2 };
+  registry.register_component<Mass>();
+  registry.create_entities<Mass>(5000);
+  SystemId heavy = registry.register_system<Mass>([] (Mass &mass) { mass.value += 1.0f; });
+  SystemId light = registry.register_system<const Mass>([] (std::span<const Mass>) {}, 2);
+  registry.set_system_label(heavy, "heavy");
+  for (int i = 0; i < 10; ++i) {
+    registry.tick();
+  }
+  Profiler &profiler = registry.get_profiler();
+  REQUIRE(profiler.get_samples(heavy).size() == 10);
+  REQUIRE(profiler.get_samples(light).size() == 5);
+  REQUIRE(profiler.get_samples(heavy).back().entities == 5000);
+  REQUIRE(profiler.get_samples(heavy).back().tick == 10);
+  REQUIRE(profiler.get_tick_timings().value().samples == 10);
+  std::ostringstream trace;
+  profiler.export_chrome_trace(trace);
+  REQUIRE(trace.str().find("\"name\":\"heavy\"") != std::string::npos);
+}
+#endif
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "WorldRegistry.hpp"
+
+struct Orbit {
+  double radius;
+  double angle;
+};
+
+struct Charge {
+  int value;
+};
+
+struct Sample {
+  float points[4];
+  float weight;
+};
+
+ECS_SPLIT_COMPONENT(Sample, &Sample::points, &Sample::weight)
+
+struct Caption {
+  std::string text;
+};
+
+TEST_CASE("Snapshot round trip into a new registry", "[snapshot]") {
+  std::string path { "snapshot_round_trip.bin" };
+  std::vector<EntityId> entities;
+  EntityId deleted;
+  {
+    WorldRegistry registry {};
+    registry.register_component<Orbit>();
+    registry.register_component<Charge>();
+    registry.register_component<Sample>();
+    entities = registry.create_entities<Orbit>(2 * Column::chunk_rows + 10, [] (std::size_t i) {
+      return std::make_tuple(Orbit { (double) i, 0.5 });
+    });
+    for (std::size_t i = 0; i < 100; ++i) {
+      registry.add_component<Charge>(entities[i]);
+      registry.attach_component(entities[i], Charge { (int) i });
+    }
+    std::vector<EntityId> samples = registry.create_entities<Sample, Charge>(3, [] (std::size_t i) {
+      return std::make_tuple(Sample { { (float) i, 1, 2, 3 }, 0.25f }, Charge { -1 });
+    });
+    entities.insert(entities.end(), samples.begin(), samples.end());
+    deleted = entities[5];
+    registry.delete_entity(deleted);
+    registry.save_snapshot(path);
+  }
+
+  WorldRegistry registry {};
+  registry.register_component<Sample>();
+  registry.register_component<Charge>();
+  registry.register_component<Orbit>();
+  std::size_t orbits = 0;
+  registry.register_system<const Orbit>([&] (const Orbit &) { ++orbits; });
+  registry.create_entity<Orbit>();
+  registry.load_snapshot(path);
+  std::remove(path.c_str());
+
+  registry.tick();
+  REQUIRE(orbits == 2 * Column::chunk_rows + 9);
+  REQUIRE(registry.get_component<Orbit>(entities[2048]).value().radius == 2048.0);
+  REQUIRE(registry.get_component<Charge>(entities[42]).value().value == 42);
+  REQUIRE(!registry.get_component<Charge>(entities[100]).has_value());
+  REQUIRE(registry.get_component<Sample>(entities.back()).value().points[0] == 2.0f);
+  REQUIRE(registry.get_component<Sample>(entities.back()).value().weight == 0.25f);
+  REQUIRE(!registry.get_component<Orbit>(deleted).has_value());
+
+  EntityId reused = registry.create_entity<Orbit>();
+  REQUIRE(entity_slot(reused) == entity_slot(deleted));
+  REQUIRE(reused != deleted);
+  registry.delete_entity(entities[0]);
+  REQUIRE(registry.get_component<Orbit>(entities[2 * Column::chunk_rows + 9]).value().radius
+          == 2 * Column::chunk_rows + 9);
+}
+
+TEST_CASE("Snapshot rejects what it cannot restore", "[snapshot]") {
+  std::string path { "snapshot_rejects.bin" };
+  WorldRegistry registry {};
+  registry.register_component<Caption>();
+  registry.register_component<Charge>();
+  EntityId captioned = registry.create_entity<Caption>();
+  REQUIRE_THROWS(registry.save_snapshot(path));
+
+  registry.delete_entity(captioned);
+  registry.create_entity<Charge>();
+  registry.save_snapshot(path);
+  WorldRegistry other {};
+  other.register_component<Orbit>();
+  REQUIRE_THROWS(other.load_snapshot(path));
+
+  registry.create_entities<Charge>(3000);
+  registry.save_snapshot(path);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+  WorldRegistry live { 10, 1 };
+  live.register_component<Charge>();
+  EntityId kept = live.create_entity<Charge>();
+  live.attach_component(kept, Charge { 7 });
+  REQUIRE_THROWS(live.load_snapshot(path));
+  REQUIRE(live.get_component<Charge>(kept).value().value == 7);
+
+  // Entity handles repeated in a row, across archetypes, or both live and free. The handles
+  // reuse deleted slots, so their bytes only show up in the entity lists
+  auto patch = [&] (EntityId from, EntityId to) {
+    std::string bytes;
+    {
+      std::ifstream file { path, std::ios::binary };
+      bytes.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    std::string needle(reinterpret_cast<const char*>(&from), sizeof(EntityId));
+    std::size_t offset { bytes.rfind(needle) };
+    REQUIRE(offset != std::string::npos);
+    bytes.replace(offset, sizeof(EntityId), reinterpret_cast<const char*>(&to), sizeof(EntityId));
+    std::ofstream file { path, std::ios::binary | std::ios::trunc };
+    file.write(bytes.data(), bytes.size());
+  };
+  WorldRegistry source {};
+  source.register_component<Charge>();
+  source.register_component<Orbit>();
+  live.register_component<Orbit>();
+  for (EntityId entity: source.create_entities<Charge>(4)) {
+    source.delete_entity(entity);
+  }
+  std::vector<EntityId> charges = source.create_entities<Charge>(2);
+  EntityId orbit = source.create_entity<Orbit>();
+  EntityId freed = source.create_entity<Charge>();
+  source.delete_entity(freed);
+  source.save_snapshot(path);
+  patch(charges[1], charges[0]);
+  REQUIRE_THROWS(live.load_snapshot(path));
+  source.save_snapshot(path);
+  patch(orbit, charges[0]);
+  REQUIRE_THROWS(live.load_snapshot(path));
+  source.save_snapshot(path);
+  patch(charges[1], freed);
+  REQUIRE_THROWS(live.load_snapshot(path));
+  REQUIRE(live.get_component<Charge>(kept).value().value == 7);
+  source.save_snapshot(path);
+  live.load_snapshot(path);
+  REQUIRE(live.get_component<Charge>(charges[1]).has_value());
+
+  {
+    std::fstream file { path, std::ios::binary | std::ios::in | std::ios::out };
+    file.write("garbage", 7);
+  }
+  REQUIRE_THROWS(registry.load_snapshot(path));
+  std::remove(path.c_str());
+  REQUIRE_THROWS(registry.load_snapshot(path));
+}
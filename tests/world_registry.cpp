@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <memory>
 #include <catch2/catch_test_macros.hpp>
+#include "Kernels.hpp"
 #include "WorldRegistry.hpp"
 
 struct Velocity {
@@ -230,8 +232,8 @@ TEST_CASE("Insertion on graph", "[graph_insertion]") {
 
   REQUIRE(std::count(graph.begin(), graph.end(), speed) == 1);
   REQUIRE(std::count(graph.begin(), graph.end(), velocity) == 2);
-  REQUIRE(std::count(graph.begin(), graph.end(), acceleration) == 4);
-  REQUIRE(std::count(graph.begin(), graph.end(), gravity) == 2);
+  REQUIRE(std::count(graph.begin(), graph.end(), acceleration) == 2);
+  REQUIRE(std::count(graph.begin(), graph.end(), gravity) == 4);
 }
 
 TEST_CASE("Adding component to entity", "[add_component]") {
@@ -414,3 +416,597 @@ TEST_CASE("System and archetype matching on the fly", "[system_archetype_matchin
   REQUIRE(velocity_result.x == 1);
   REQUIRE(velocity_result.y == 5);
 }
+
+TEST_CASE("Entity deletion keeps the archetype dense", "[entity_delete_compaction]") {
+  WorldRegistry registry { 10 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  EntityId entities [4];
+  for (int i = 0; i < 4; ++i) {
+    entities[i] = registry.create_entity<Velocity, Speed>();
+    registry.attach_component(entities[i], (Velocity){i, 0});
+    registry.attach_component(entities[i], (Speed){0, 0, 0});
+  }
+  int visited = 0;
+  registry.register_system<Velocity, Speed>([&] (Velocity *v, Speed *s) {
+    s->x += v->x;
+    ++visited;
+  });
+  registry.delete_entity(entities[1]);
+  registry.remove_component<Speed>(entities[0]);
+  registry.tick();
+  REQUIRE(visited == 2);
+  REQUIRE(registry.get_component<Speed>(entities[2]).value().x == 2);
+  REQUIRE(registry.get_component<Speed>(entities[3]).value().x == 3);
+  REQUIRE(registry.get_component<Velocity>(entities[3]).value().x == 3);
+  REQUIRE(registry.get_component<Velocity>(entities[0]).value().x == 0);
+}
+
+TEST_CASE("Random access through component pointers", "[random_access]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  EntityId entity = registry.create_entity<Velocity, Speed>();
+  registry.attach_component(entity, (Velocity){1, 2});
+  registry.attach_component(entity, (Speed){3, 4, 5});
+
+  Velocity *velocity = registry.try_get<Velocity>(entity);
+  REQUIRE(velocity != nullptr);
+  velocity->y = 20;
+  REQUIRE(registry.get_component<Velocity>(entity).value().y == 20);
+  REQUIRE(registry.try_get<Gravity>(entity) == nullptr);
+
+  auto [speed, gravity, read_only] = registry.get<Speed, Gravity, const Velocity>(entity);
+  REQUIRE(speed->z == 5);
+  REQUIRE(gravity == nullptr);
+  REQUIRE(read_only == velocity);
+
+  registry.add_component<Gravity>(entity);
+  registry.try_get<Gravity>(entity)->g = 9.8f;
+  REQUIRE(registry.try_get<Velocity>(entity)->y == 20);
+  REQUIRE(std::get<Gravity*>(registry.get<Velocity, Gravity>(entity))->g == 9.8f);
+
+  registry.delete_entity(entity);
+  REQUIRE(registry.try_get<Velocity>(entity) == nullptr);
+  auto [stale_velocity, stale_speed] = registry.get<Velocity, Speed>(entity);
+  REQUIRE(stale_velocity == nullptr);
+  REQUIRE(stale_speed == nullptr);
+}
+
+TEST_CASE("Entity slots are recycled with a new generation", "[entity_recycling]") {
+  WorldRegistry registry {};
+  registry.register_component<Speed>();
+  EntityId entity = registry.create_entity<Speed>();
+  registry.attach_component(entity, (Speed){1, 2, 3});
+  registry.delete_entity(entity);
+  EntityId recycled = registry.create_entity<Speed>();
+  registry.attach_component(recycled, (Speed){4, 5, 6});
+  REQUIRE(entity_slot(recycled) == entity_slot(entity));
+  REQUIRE(entity_generation(recycled) == entity_generation(entity) + 1);
+  REQUIRE(registry.get_component<Speed>(entity) == std::nullopt);
+  REQUIRE(registry.get_component<Speed>(recycled).value().x == 4);
+  registry.delete_entity(entity);
+  REQUIRE(registry.get_component<Speed>(recycled).value().y == 5);
+}
+
+TEST_CASE("Bulk entity creation", "[bulk_creation]") {
+  WorldRegistry registry {};
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  const std::size_t amount = 3000;
+  std::vector<Velocity> velocities;
+  std::vector<Speed> speeds;
+  for (std::size_t i = 0; i < amount; ++i) {
+    velocities.push_back((Velocity){(int) i, 1});
+    speeds.push_back((Speed){2, (int) i, 3});
+  }
+  std::vector<EntityId> from_spans = registry.create_entities<Velocity, Speed>(
+      std::span<const Velocity>(velocities), std::span<const Speed>(speeds));
+  REQUIRE(from_spans.size() == amount);
+  REQUIRE(registry.get_component<Velocity>(from_spans[2500]).value().x == 2500);
+  REQUIRE(registry.get_component<Speed>(from_spans[1500]).value().y == 1500);
+
+  std::vector<EntityId> generated = registry.create_entities<Velocity, Speed>(amount, [] (std::size_t i) {
+    return std::make_tuple((Velocity){(int) i, 7}, (Speed){(int) (2 * i), 0, 0});
+  });
+  REQUIRE(registry.get_component<Velocity>(generated[2999]).value().x == 2999);
+  REQUIRE(registry.get_component<Velocity>(generated[1024]).value().y == 7);
+  REQUIRE(registry.get_component<Speed>(generated[1025]).value().x == 2050);
+
+  std::vector<EntityId> zeroed = registry.create_entities<Speed>(10);
+  REQUIRE(registry.get_component<Speed>(zeroed[9]).value().z == 0);
+}
+
+TEST_CASE("Iterating a view", "[view]") {
+  WorldRegistry registry {};
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  registry.create_entities<Velocity, Speed>(1500, [] (std::size_t i) {
+    return std::make_tuple((Velocity){1, 2}, (Speed){0, 0, 0});
+  });
+  EntityId other = registry.create_entity<Speed, Gravity, Velocity>();
+  registry.attach_component(other, (Velocity){3, 4});
+  registry.create_entity<Velocity>();
+
+  std::size_t rows = 0;
+  for (auto [velocities, speeds]: registry.view<const Velocity, Speed>()) {
+    for (std::size_t i = 0; i < speeds.size(); ++i) {
+      speeds[i].x += velocities[i].x;
+      speeds[i].y += velocities[i].y;
+    }
+    rows += speeds.size();
+  }
+  REQUIRE(rows == 1501);
+  REQUIRE(registry.get_component<Speed>(other).value().x == 3);
+  REQUIRE(registry.get_component<Speed>(other).value().y == 4);
+
+  int total = 0;
+  registry.view<Speed>().each([&] (Speed &s) { total += s.x; });
+  REQUIRE(total == 1503);
+}
+
+TEST_CASE("Systems taking references and chunk spans", "[system_forms]") {
+  WorldRegistry registry { 10 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_system<Velocity, Speed>([] (Velocity &v, Speed &s) {
+    s.x += v.x;
+  });
+  std::size_t kernel_rows = 0;
+  registry.register_system<Velocity, Speed>([&] (std::span<Velocity> v, std::span<Speed> s) {
+    for (std::size_t i = 0; i < s.size(); ++i) {
+      s[i].y += v[i].y;
+    }
+    kernel_rows += s.size();
+  });
+  std::vector<EntityId> entities = registry.create_entities<Velocity, Speed>(2000, [] (std::size_t i) {
+    return std::make_tuple((Velocity){1, 2}, (Speed){0, 0, 0});
+  });
+  registry.tick();
+  REQUIRE(kernel_rows == 2000);
+  Speed result = registry.get_component<Speed>(entities[1999]).value();
+  REQUIRE(result.x == 1);
+  REQUIRE(result.y == 2);
+}
+
+TEST_CASE("Parallel systems follow the declared access", "[parallel_schedule]") {
+  WorldRegistry registry { 10, 4 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Acceleration>();
+  std::vector<EntityId> entities = registry.create_entities<Velocity, Speed, Acceleration>(5000, [] (std::size_t i) {
+    return std::make_tuple((Velocity){1, 1}, (Speed){0, 0, 0}, (Acceleration){0, 0});
+  });
+  registry.register_system<const Velocity, Speed>([] (const Velocity &v, Speed &s) {
+    s.x += v.x;
+  });
+  registry.register_system<const Velocity, Acceleration>([] (const Velocity &v, Acceleration &a) {
+    a.x += v.x;
+  });
+  registry.register_system<Velocity>([] (Velocity &v) {
+    v.x *= 2;
+  });
+  registry.register_system<const Speed>([] (const Speed &) {});
+  for (int i = 0; i < 3; ++i) {
+    registry.tick();
+  }
+  REQUIRE(registry.get_component<Speed>(entities[4999]).value().x == 7);
+  REQUIRE(registry.get_component<Acceleration>(entities[0]).value().x == 7);
+  REQUIRE(registry.get_component<Velocity>(entities[100]).value().x == 8);
+}
+
+TEST_CASE("Data parallel system and view", "[parallel_each]") {
+  WorldRegistry registry { 10, 4 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  std::vector<EntityId> entities = registry.create_entities<Velocity, Speed>(10000, [] (std::size_t i) {
+    return std::make_tuple((Velocity){(int) i, 1}, (Speed){0, 0, 0});
+  });
+  registry.register_parallel_system<const Velocity, Speed>([] (const Velocity &v, Speed &s) {
+    s.x += v.x;
+  });
+  registry.tick();
+  registry.view<Speed>().par_each(registry.get_thread_pool(), [] (Speed &s) {
+    s.y += 1;
+  });
+  for (std::size_t i = 0; i < entities.size(); i += 997) {
+    Speed speed = registry.get_component<Speed>(entities[i]).value();
+    REQUIRE(speed.x == (int) i);
+    REQUIRE(speed.y == 1);
+  }
+}
+
+TEST_CASE("Multi rate systems and disabled systems", "[system_rates]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.create_entity<Velocity>();
+  std::vector<int> every_tick, first_half, second_half, disabled;
+  int tick = 0;
+  registry.register_system<Velocity>([&] (Velocity *) { every_tick.push_back(tick); });
+  registry.register_system<Velocity>([&] (Velocity *) { first_half.push_back(tick); }, 2);
+  registry.register_system<Velocity>([&] (Velocity *) { second_half.push_back(tick); }, 2);
+  SystemId disabled_id = registry.register_system<Velocity>([&] (Velocity *) { disabled.push_back(tick); });
+  registry.disable_system(disabled_id);
+  for (tick = 0; tick < 4; ++tick) {
+    registry.tick();
+  }
+  REQUIRE(every_tick == std::vector<int>{0, 1, 2, 3});
+  REQUIRE(first_half == std::vector<int>{0, 2});
+  REQUIRE(second_half == std::vector<int>{1, 3});
+  REQUIRE(disabled.empty());
+  registry.enable_system(disabled_id);
+  registry.tick();
+  REQUIRE(disabled.size() == 1);
+}
+
+TEST_CASE("Tick rates that do not divide the cycle", "[system_rates]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.create_entity<Velocity>();
+  int every_fourth = 0;
+  std::vector<int> staggered;
+  int tick = 0;
+  registry.register_system<Velocity>([&] (Velocity *) { ++every_fourth; }, 4);
+  for (int i = 0; i < 12; ++i) {
+    registry.register_system<Velocity>([&, i] (Velocity *) {
+      if (i == 0 || i == 11)
+        staggered.push_back(tick);
+    }, 60);
+  }
+  for (tick = 0; tick < 120; ++tick) {
+    registry.tick();
+  }
+  REQUIRE(every_fourth == 30);
+  REQUIRE(staggered == std::vector<int>{0, 11, 60, 71});
+}
+
+TEST_CASE("System archetype cache follows archetype creation and pruning", "[system_archetype_cache]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  int runs = 0;
+  registry.register_system<Velocity, Speed>([&] (Velocity *, Speed *) { ++runs; });
+  EntityId first = registry.create_entity<Velocity, Speed>();
+  EntityId second = registry.create_entity<Gravity, Speed, Velocity>();
+  registry.create_entity<Velocity>();
+  registry.tick();
+  REQUIRE(runs == 2);
+  registry.delete_entity(second);
+  REQUIRE(registry.prune_empty_archetypes() == 1);
+  registry.tick();
+  REQUIRE(runs == 3);
+  EntityId third = registry.create_entity<Gravity, Speed, Velocity>();
+  registry.attach_component(third, (Gravity){9.8f});
+  registry.tick();
+  REQUIRE(runs == 5);
+  REQUIRE(registry.get_component<Gravity>(third).value().g == 9.8f);
+  REQUIRE(registry.get_component<Speed>(first).has_value());
+}
+
+TEST_CASE("Identical component sets share one archetype", "[canonical_archetypes]") {
+  WorldRegistry registry {};
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Acceleration>();
+  EntityId first = registry.create_entity<Velocity, Speed>();
+  EntityId second = registry.create_entity<Speed, Velocity>();
+  REQUIRE(registry.get_archetype_id<Velocity, Speed>() == registry.get_archetype_id<Speed, Velocity>());
+  EntityId third = registry.create_entity<Velocity>();
+  EntityId fourth = registry.create_entity<Speed>();
+  archetype_t from_velocity = registry.add_component<Speed>(third);
+  archetype_t from_speed = registry.add_component<Velocity>(fourth);
+  REQUIRE(from_velocity == from_speed);
+  REQUIRE(from_velocity->get_id() == registry.get_archetype_id<Velocity, Speed>());
+  registry.attach_component(second, (Velocity){3, 4});
+  REQUIRE(registry.get_component<Velocity>(second).value().y == 4);
+  REQUIRE(registry.get_component<Velocity>(first).value().y == 0);
+}
+
+TEST_CASE("Transition edges are cached in both directions", "[archetype_edges]") {
+  WorldRegistry registry {};
+  registry.register_component<Velocity>();
+  registry.register_component<Gravity>();
+  ComponentId gravity = registry.get_component_id<Gravity>();
+  EntityId entity = registry.create_entity<Velocity>();
+  registry.attach_component(entity, (Velocity){7, 8});
+  archetype_t with_gravity = registry.add_component<Gravity>(entity);
+  archetype_t without_gravity = registry.remove_component<Gravity>(entity);
+  REQUIRE(without_gravity->find_edge(gravity)->add == with_gravity);
+  REQUIRE(with_gravity->find_edge(gravity)->remove == without_gravity);
+  for (int i = 0; i < 10; ++i) {
+    REQUIRE(registry.add_component<Gravity>(entity) == with_gravity);
+    REQUIRE(registry.remove_component<Gravity>(entity) == without_gravity);
+  }
+  REQUIRE(registry.get_component<Velocity>(entity).value().y == 8);
+  REQUIRE(registry.prune_empty_archetypes() == 1);
+  REQUIRE(without_gravity->find_edge(gravity)->add == nullptr);
+}
+
+TEST_CASE("Archetypes stay in place while others are created and pruned", "[archetype_table]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  EntityId entity = registry.create_entity<Velocity>();
+  registry.attach_component(entity, (Velocity){1, 2});
+  archetype_t with_speed = registry.add_component<Speed>(entity);
+  for (int i = 0; i < 100; ++i) {
+    registry.create_entity<Gravity>();
+    EntityId moving = registry.create_entity<Velocity, Gravity>();
+    registry.remove_component<Gravity>(moving);
+    registry.delete_entity(moving);
+    registry.prune_empty_archetypes();
+  }
+  REQUIRE(registry.add_component<Gravity>(entity) != with_speed);
+  REQUIRE(registry.remove_component<Gravity>(entity) == with_speed);
+  REQUIRE(with_speed->size() == 1);
+  REQUIRE(registry.get_component<Velocity>(entity).value().y == 2);
+  int runs = 0;
+  registry.register_system<Velocity, Gravity>([&] (Velocity &, Gravity &) { ++runs; });
+  registry.tick();
+  REQUIRE(runs == 0);
+}
+
+TEST_CASE("Command buffers flushed after the systems", "[command_buffer]") {
+  WorldRegistry registry { 10, 4 };
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  std::vector<EntityId> entities = registry.create_entities<Velocity>(3000, [] (std::size_t i) {
+    return std::make_tuple((Velocity){(int) i, 0});
+  });
+  registry.register_parallel_system<const Velocity>([&] (std::span<const Velocity> velocities) {
+    CommandBuffer &commands = registry.commands();
+    for (const Velocity &v: velocities) {
+      EntityId entity = entities[v.x];
+      if (v.x % 3 == 0) {
+        commands.despawn(entity);
+      } else if (v.x % 3 == 1) {
+        commands.add<Speed>(entity, (Speed){v.x, 0, 0});
+        commands.add<Gravity>(entity);
+        commands.remove<Gravity>(entity);
+      } else {
+        commands.set<Velocity>(entity, (Velocity){v.x, 5});
+        commands.set<Speed>(entity, (Speed){1, 1, 1});
+      }
+    }
+  });
+  registry.commands().spawn((Velocity){-1, -1}, (Gravity){1.5f});
+  registry.tick();
+  for (int i = 0; i < 3000; ++i) {
+    if (i % 3 == 0) {
+      REQUIRE(registry.get_component<Velocity>(entities[i]) == std::nullopt);
+    } else if (i % 3 == 1) {
+      REQUIRE(registry.get_component<Speed>(entities[i]).value().x == i);
+      REQUIRE(registry.get_component<Velocity>(entities[i]).value().x == i);
+      REQUIRE(registry.get_component<Gravity>(entities[i]) == std::nullopt);
+    } else {
+      REQUIRE(registry.get_component<Velocity>(entities[i]).value().y == 5);
+      REQUIRE(registry.get_component<Speed>(entities[i]) == std::nullopt);
+    }
+  }
+  int spawned = 0;
+  registry.view<Velocity, Gravity>().each([&] (Velocity &v, Gravity &g) {
+    REQUIRE(v.x == -1);
+    REQUIRE(g.g == 1.5f);
+    ++spawned;
+  });
+  REQUIRE(spawned == 1);
+}
+
+TEST_CASE("Commands apply in recording order whatever thread ran the chunks", "[command_buffer]") {
+  for (int run = 0; run < 5; ++run) {
+    WorldRegistry registry { 10, 4 };
+    registry.register_component<Velocity>();
+    registry.register_component<Speed>();
+    std::vector<EntityId> entities = registry.create_entities<Velocity>(8 * Column::chunk_rows, [] (std::size_t i) {
+      return std::make_tuple((Velocity){(int) i, 0});
+    });
+    registry.register_parallel_system<const Velocity>([&] (std::span<const Velocity> velocities) {
+      registry.commands().spawn((Speed){velocities[0].x, 0, 0});
+      registry.commands().set<Velocity>(entities[0], (Velocity){0, velocities[0].x});
+    });
+    registry.tick();
+    std::vector<int> spawned;
+    registry.view<Speed>().each([&] (Speed &speed) { spawned.push_back(speed.x); });
+    REQUIRE(spawned.size() == 8);
+    REQUIRE(std::is_sorted(spawned.begin(), spawned.end()));
+    REQUIRE(registry.get_component<Velocity>(entities[0]).value().y == 7 * Column::chunk_rows);
+  }
+}
+
+TEST_CASE("Commands recorded in par_each apply in chunk order", "[command_buffer]") {
+  for (int run = 0; run < 5; ++run) {
+    WorldRegistry registry { 10, 4 };
+    registry.register_component<Velocity>();
+    registry.register_component<Speed>();
+    std::vector<EntityId> entities = registry.create_entities<Velocity>(8 * Column::chunk_rows, [] (std::size_t i) {
+      return std::make_tuple((Velocity){(int) i, 0});
+    });
+    registry.view<const Velocity>().par_each(registry.get_thread_pool(), [&] (const Velocity &velocity) {
+      if (velocity.x % Column::chunk_rows == 0) {
+        registry.commands().spawn((Speed){velocity.x, 0, 0});
+        registry.commands().set<Velocity>(entities[0], (Velocity){0, velocity.x});
+      }
+    });
+    registry.flush_commands();
+    std::vector<int> spawned;
+    registry.view<Speed>().each([&] (Speed &speed) { spawned.push_back(speed.x); });
+    REQUIRE(spawned.size() == 8);
+    REQUIRE(std::is_sorted(spawned.begin(), spawned.end()));
+    REQUIRE(registry.get_component<Velocity>(entities[0]).value().y == 7 * Column::chunk_rows);
+  }
+}
+
+TEST_CASE("Adding and removing components for a whole query", "[query_migration]") {
+  WorldRegistry registry {};
+  registry.register_component<Velocity>();
+  registry.register_component<Speed>();
+  registry.register_component<Gravity>();
+  std::vector<EntityId> moving = registry.create_entities<Velocity, Speed>(2500, [] (std::size_t i) {
+    return std::make_tuple((Velocity){(int) i, 0}, (Speed){0, (int) i, 0});
+  });
+  std::vector<EntityId> still = registry.create_entities<Speed>(700, [] (std::size_t i) {
+    return std::make_tuple((Speed){(int) i, 0, 0});
+  });
+  REQUIRE(registry.add_component<Gravity>(registry.view<Speed>(), (Gravity){2.0f}) == 3200);
+  REQUIRE(registry.add_component<Gravity>(registry.view<Speed>()) == 0);
+  REQUIRE(registry.get_component<Gravity>(moving[2499]).value().g == 2.0f);
+  REQUIRE(registry.get_component<Gravity>(still[0]).value().g == 2.0f);
+  REQUIRE(registry.get_component<Velocity>(moving[1234]).value().x == 1234);
+  REQUIRE(registry.get_component<Speed>(moving[2048]).value().y == 2048);
+  REQUIRE(registry.get_component<Speed>(still[699]).value().x == 699);
+
+  REQUIRE(registry.remove_component<Speed>(registry.view<Velocity, Gravity>()) == 2500);
+  REQUIRE(registry.get_component<Speed>(moving[10]) == std::nullopt);
+  REQUIRE(registry.get_component<Velocity>(moving[1500]).value().x == 1500);
+  REQUIRE(registry.get_component<Speed>(still[300]).value().x == 300);
+
+  registry.remove_component<Gravity>(moving[0]);
+  registry.remove_component<Gravity>(moving[1]);
+  REQUIRE(registry.get_component<Velocity>(moving[2499]).value().x == 2499);
+  REQUIRE(registry.get_component<Velocity>(moving[1]).value().x == 1);
+  REQUIRE(registry.get_component<Gravity>(moving[2]).value().g == 2.0f);
+}
+
+struct Name {
+  std::string value;
+};
+
+struct Inventory {
+  std::vector<std::string> items;
+};
+
+TEST_CASE("Components that are not trivially copyable", "[non_trivial_components]") {
+  WorldRegistry registry {};
+  registry.register_component<Name>();
+  registry.register_component<Inventory>();
+  registry.register_component<Velocity>();
+  std::vector<EntityId> entities = registry.create_entities<Name, Velocity>(1500, [] (std::size_t i) {
+    return std::make_tuple(Name { "entity number " + std::to_string(i) }, (Velocity){(int) i, 0});
+  });
+  registry.add_component<Inventory>(entities[7]);
+  registry.attach_component(entities[7], Inventory { { "sword", "shield" } });
+  REQUIRE(registry.get_component<Name>(entities[7]).value().value == "entity number 7");
+  REQUIRE(registry.add_component<Inventory>(registry.view<Name>(), Inventory { { "potion" } }) == 1499);
+  REQUIRE(registry.get_component<Inventory>(entities[7]).value().items.size() == 2);
+  REQUIRE(registry.get_component<Inventory>(entities[1499]).value().items[0] == "potion");
+  REQUIRE(registry.get_component<Name>(entities[1499]).value().value == "entity number 1499");
+
+  registry.delete_entity(entities[0]);
+  registry.remove_component<Name>(entities[1]);
+  REQUIRE(registry.get_component<Name>(entities[1]) == std::nullopt);
+  REQUIRE(registry.get_component<Inventory>(entities[1]).value().items[0] == "potion");
+
+  registry.commands().set<Name>(entities[2], Name { "renamed by a command buffer" });
+  registry.commands().spawn(Name { "spawned by a command buffer" }, Inventory { { "map" } });
+  registry.tick();
+  REQUIRE(registry.get_component<Name>(entities[2]).value().value == "renamed by a command buffer");
+  int spawned = 0;
+  registry.view<Name, Inventory>().each([&] (Name &name, Inventory &inventory) {
+    if (name.value == "spawned by a command buffer") {
+      REQUIRE(inventory.items[0] == "map");
+      ++spawned;
+    }
+  });
+  REQUIRE(spawned == 1);
+  registry.prune_empty_archetypes();
+}
+
+struct Owned {
+  std::unique_ptr<int> value;
+};
+
+TEST_CASE("Move only components through the command buffers", "[command_buffer]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Velocity>();
+  registry.register_component<Owned>();
+  EntityId entity = registry.create_entity<Velocity>();
+  registry.commands().add<Owned>(entity, Owned { std::make_unique<int>(1) });
+  registry.commands().spawn((Velocity){2, 0}, Owned { std::make_unique<int>(2) });
+  registry.flush_commands();
+  REQUIRE(*registry.try_get<Owned>(entity)->value == 1);
+  registry.commands().set<Owned>(entity, Owned { std::make_unique<int>(3) });
+  registry.tick();
+  REQUIRE(*registry.try_get<Owned>(entity)->value == 3);
+  int spawned = 0;
+  registry.view<Velocity, Owned>().each([&] (Velocity &velocity, Owned &owned) {
+    if (velocity.x == 2) {
+      REQUIRE(*owned.value == 2);
+      ++spawned;
+    }
+  });
+  REQUIRE(spawned == 1);
+}
+
+struct Particle {
+  float position[3];
+  float velocity[3];
+  float mass;
+  float charge;
+};
+
+ECS_SPLIT_COMPONENT(Particle, &Particle::position, &Particle::velocity, &Particle::mass)
+
+TEST_CASE("Split components through views, systems and migrations", "[split_components]") {
+  WorldRegistry registry {};
+  registry.register_component<Particle>();
+  registry.register_component<Velocity>();
+  std::vector<EntityId> entities = registry.create_entities<Particle>(3000, [] (std::size_t i) {
+    return std::make_tuple((Particle){{(float) i, 0, 0}, {1, 2, 3}, 2.0f, 5.0f});
+  });
+  registry.register_system<Particle>([] (FieldSpans<Particle> particles) {
+    auto positions = particles.get<&Particle::position>();
+    auto velocities = particles.get<&Particle::velocity>();
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      for (int axis = 0; axis < 3; ++axis) {
+        positions[i][axis] += velocities[i][axis];
+      }
+    }
+  });
+  registry.tick();
+  Particle particle = registry.get_component<Particle>(entities[2048]).value();
+  REQUIRE(particle.position[0] == 2049.0f);
+  REQUIRE(particle.position[2] == 3.0f);
+  REQUIRE(particle.mass == 2.0f);
+  REQUIRE(particle.charge == 0.0f);
+  REQUIRE(registry.get_component(entities[0], registry.get_component_id<Particle>()) == nullptr);
+
+  registry.add_component<Velocity>(entities[10]);
+  registry.delete_entity(entities[0]);
+  REQUIRE(registry.get_component<Particle>(entities[10]).value().position[0] == 11.0f);
+  REQUIRE(registry.get_component<Particle>(entities[2999]).value().position[0] == 3000.0f);
+
+  float total_mass = 0;
+  registry.view<const Particle>().each([&] (FieldSpans<const Particle>::reference particle) {
+    total_mass += particle.get<&Particle::mass>();
+  });
+  REQUIRE(total_mass == 2.0f * 2999);
+}
+
+TEST_CASE("Chunk kernels with aligned spans", "[aligned_kernels]") {
+  WorldRegistry registry { 10, 1 };
+  registry.register_component<Particle>();
+  registry.register_component<Velocity>();
+  std::vector<EntityId> entities = registry.create_entities<Particle, Velocity>(2500, [] (std::size_t i) {
+    return std::make_tuple((Particle){{0, 0, 0}, {1, 2, 3}, (float) i, 0}, (Velocity){(int) i, 0});
+  });
+  bool aligned = true;
+  registry.register_system<Particle>([&] (FieldSpans<Particle> particles) {
+    AlignedSpan<float> mass = particles.aligned<&Particle::mass>();
+    aligned = aligned && reinterpret_cast<std::uintptr_t>(mass.data()) % simd_alignment == 0;
+    scale(mass, 2.0f);
+  });
+  std::size_t rows = 0;
+  registry.register_system<const Velocity>([&] (AlignedSpan<const Velocity> velocities) {
+    aligned = aligned && reinterpret_cast<std::uintptr_t>(velocities.data()) % simd_alignment == 0;
+    rows += velocities.size();
+  });
+  registry.tick();
+  REQUIRE(aligned);
+  REQUIRE(rows == 2500);
+  REQUIRE(registry.get_component<Particle>(entities[1500]).value().mass == 3000.0f);
+}